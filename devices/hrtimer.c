@@ -0,0 +1,269 @@
+#include "devices/hrtimer.h"
+#include <debug.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include "devices/lapic.h"
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "intrinsic.h"
+
+#define NS_PER_SEC 1000000000LL
+#define NS_PER_TICK (NS_PER_SEC / TIMER_FREQ)
+
+/* Number of timer ticks to calibrate over. */
+#define CALIBRATE_TICKS 5
+
+/* hrtimer_now() scales TSC cycles to nanoseconds as
+   (cycles * tsc_mult) >> TSC_SHIFT. */
+#define TSC_SHIFT 32
+
+static bool calibrated;             /* Has hrtimer_init() run? */
+static bool use_lapic;              /* Local APIC timer available? */
+static uint64_t tsc_mult;           /* Nanoseconds per cycle, scaled. */
+static uint64_t base_tsc;           /* TSC when the clock was set. */
+static int64_t base_ns;             /* hrtimer_now() at BASE_TSC. */
+static int64_t lapic_hz;            /* Local APIC timer counts per second. */
+
+/* Pending events, earliest first.  Protected by disabling
+   interrupts.  Only the bootstrap processor's local APIC timer
+   is used. */
+static struct heap pending;
+
+static intr_handler_func hrtimer_interrupt;
+static void program_next (void);
+static void run_expired (void);
+
+static bool
+expires_less (const struct heap_elem *a_, const struct heap_elem *b_,
+              void *aux UNUSED) {
+	const struct hrtimer_event *a = heap_entry (a_, struct hrtimer_event, elem);
+	const struct hrtimer_event *b = heap_entry (b_, struct hrtimer_event, elem);
+
+	return a->expires < b->expires;
+}
+
+/* Calibrates the time stamp counter and, if there is one, the
+   local APIC timer against the timer tick, and starts delivering
+   high-resolution timer events.  Interrupts must be on, and
+   user processes must not yet have been created. */
+void
+hrtimer_init (void) {
+	uint64_t start_tsc, cycles;
+	uint32_t lapic_counts = 0;
+	int64_t start;
+
+	ASSERT (intr_get_level () == INTR_ON);
+
+	heap_init (&pending, expires_less, NULL);
+	use_lapic = lapic_init ();
+	if (use_lapic)
+		intr_register_ext (LAPIC_TIMER_VEC, hrtimer_interrupt,
+		                   "Local APIC Timer");
+
+	/* Count both clocks from one tick boundary to another. */
+	start = timer_ticks ();
+	while (timer_ticks () == start)
+		barrier ();
+	start_tsc = rdtsc ();
+	if (use_lapic)
+		lapic_timer_start (UINT32_MAX, false);
+	while (timer_elapsed (start) <= CALIBRATE_TICKS)
+		barrier ();
+	cycles = rdtsc () - start_tsc;
+	if (use_lapic) {
+		lapic_counts = UINT32_MAX - lapic_timer_count ();
+		lapic_timer_stop ();
+	}
+
+	enum intr_level old_level = intr_disable ();
+	base_ns = hrtimer_now ();
+	base_tsc = rdtsc ();
+	tsc_mult = ((uint64_t) NS_PER_TICK * CALIBRATE_TICKS << TSC_SHIFT)
+		/ cycles;
+	lapic_hz = (int64_t) lapic_counts * TIMER_FREQ / CALIBRATE_TICKS;
+	if (lapic_hz == 0)
+		use_lapic = false;
+	calibrated = true;
+	intr_set_level (old_level);
+
+	printf ("High-resolution timer: %'" PRIu64 " TSC cycles/s, ",
+	        cycles * TIMER_FREQ / CALIBRATE_TICKS);
+	if (use_lapic)
+		printf ("local APIC timer at %'" PRId64 " Hz.\n", lapic_hz);
+	else
+		printf ("no local APIC timer.\n");
+}
+
+/* Returns true once hrtimer_init() has run. */
+bool
+hrtimer_available (void) {
+	return calibrated;
+}
+
+/* Returns the number of nanoseconds since boot.  Before
+   hrtimer_init(), this only advances once per timer tick. */
+int64_t
+hrtimer_now (void) {
+	unsigned __int128 ns;
+
+	if (!calibrated)
+		return timer_ticks () * NS_PER_TICK;
+	ns = (unsigned __int128) (rdtsc () - base_tsc) * tsc_mult;
+	return base_ns + (int64_t) (ns >> TSC_SHIFT);
+}
+
+/* Initializes EVENT as an unarmed event that calls FUNC(AUX) when
+   it expires. */
+void
+hrtimer_event_init (struct hrtimer_event *event, timer_func *func,
+                    void *aux) {
+	ASSERT (event != NULL);
+	ASSERT (func != NULL);
+
+	event->func = func;
+	event->aux = aux;
+	event->expires = 0;
+	event->armed = false;
+}
+
+/* Arms EVENT to expire once hrtimer_now() reaches EXPIRES.  If
+   EXPIRES has already passed, the event expires right away, but
+   still from interrupt context.  Re-arming a pending event moves
+   its expiry. */
+void
+hrtimer_arm (struct hrtimer_event *event, int64_t expires) {
+	enum intr_level old_level = intr_disable ();
+
+	if (event->armed)
+		heap_remove (&pending, &event->elem);
+	event->expires = expires;
+	event->armed = true;
+	heap_insert (&pending, &event->elem);
+	if (heap_min (&pending) == &event->elem)
+		program_next ();
+
+	intr_set_level (old_level);
+}
+
+/* Disarms EVENT.  Returns true if it was pending, false if it
+   had already expired or was never armed. */
+bool
+hrtimer_cancel (struct hrtimer_event *event) {
+	enum intr_level old_level = intr_disable ();
+	bool was_armed = event->armed;
+
+	if (was_armed) {
+		heap_remove (&pending, &event->elem);
+		event->armed = false;
+	}
+
+	intr_set_level (old_level);
+	return was_armed;
+}
+
+/* Returns true if EVENT is armed and has not yet expired. */
+bool
+hrtimer_pending (const struct hrtimer_event *event) {
+	return event->armed;
+}
+
+/* Timer callback that wakes up the sleeping thread T_. */
+static void
+wake_up (void *t_) {
+	thread_unblock (t_);
+	preempt_priority ();
+}
+
+/* Blocks the running thread until hrtimer_now() reaches
+   DEADLINE. */
+void
+hrtimer_sleep_until (int64_t deadline) {
+	struct hrtimer_event wakeup;
+	enum intr_level old_level;
+
+	ASSERT (!intr_context ());
+
+	old_level = intr_disable ();
+	if (hrtimer_now () < deadline) {
+		hrtimer_event_init (&wakeup, wake_up, thread_current ());
+		hrtimer_arm (&wakeup, deadline);
+		thread_block ();
+	}
+	intr_set_level (old_level);
+}
+
+/* Blocks the running thread for NS nanoseconds. */
+void
+hrtimer_sleep (int64_t ns) {
+	hrtimer_sleep_until (hrtimer_now () + ns);
+}
+
+/* Called on every timer tick.  Without a local APIC timer, this
+   is what expires events. */
+void
+hrtimer_tick (void) {
+	if (calibrated && !use_lapic)
+		run_expired ();
+}
+
+/* Returns true if pending events rely on the timer tick to
+   expire, so that it must not be stopped while idle. */
+bool
+hrtimer_needs_tick (void) {
+	return calibrated && !use_lapic && !heap_empty (&pending);
+}
+
+/* Local APIC timer interrupt handler. */
+static void
+hrtimer_interrupt (struct intr_frame *args UNUSED) {
+	run_expired ();
+	program_next ();
+}
+
+/* Runs the callbacks of all events that are due. */
+static void
+run_expired (void) {
+	int64_t now = hrtimer_now ();
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	while (!heap_empty (&pending)) {
+		struct hrtimer_event *event =
+			heap_entry (heap_min (&pending), struct hrtimer_event, elem);
+
+		if (event->expires > now)
+			break;
+		heap_pop_min (&pending);
+		event->armed = false;
+		event->func (event->aux);
+		now = hrtimer_now ();
+	}
+}
+
+/* Programs the local APIC timer to interrupt when the earliest
+   pending event is due, or stops it if there is none.  Deadlines
+   more than a second away are approached a second at a time, to
+   keep the count within range. */
+static void
+program_next (void) {
+	struct hrtimer_event *event;
+	int64_t delta, count;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	if (!use_lapic || !calibrated)
+		return;
+	if (heap_empty (&pending)) {
+		lapic_timer_stop ();
+		return;
+	}
+
+	event = heap_entry (heap_min (&pending), struct hrtimer_event, elem);
+	delta = event->expires - hrtimer_now ();
+	if (delta > NS_PER_SEC)
+		delta = NS_PER_SEC;
+	count = delta > 0 ? delta * lapic_hz / NS_PER_SEC : 0;
+	lapic_timer_start (count > 0 ? (count < UINT32_MAX ? count : UINT32_MAX) : 1,
+	                   true);
+}
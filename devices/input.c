@@ -1,15 +1,33 @@
 #include "devices/input.h"
 #include <debug.h>
-#include "devices/intq.h"
+#include <ring.h>
 #include "devices/serial.h"
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
 
-/* Stores keys from the keyboard and serial port. */
-static struct intq buffer;
+/* Input buffer size, in bytes.  Must be a power of 2. */
+#define INPUT_BUFSIZE 64
+
+/* Stores keys from the keyboard and serial port.  The interrupt
+   handlers that add keys are its producer, and input_read() is
+   its consumer. */
+static struct ring buffer;
+static uint8_t buffer_data[INPUT_BUFSIZE];
+
+/* Admits one reader at a time, which keeps the ring down to a
+   single consumer and lets it have a single waiting thread. */
+static struct lock reader_lock;
+
+/* The reader, if it is asleep waiting for a key. */
+static struct thread *waiter;
 
 /* Initializes the input buffer. */
 void
 input_init (void) {
-	intq_init (&buffer);
+	ring_init (&buffer, buffer_data, INPUT_BUFSIZE, 1);
+	lock_init (&reader_lock);
+	waiter = NULL;
 }
 
 /* Adds a key to the input buffer.
@@ -17,24 +35,52 @@ input_init (void) {
 void
 input_putc (uint8_t key) {
 	ASSERT (intr_get_level () == INTR_OFF);
-	ASSERT (!intq_full (&buffer));
+	ASSERT (!ring_full (&buffer));
 
-	intq_putc (&buffer, key);
+	ring_push (&buffer, &key);
 	serial_notify ();
+	if (waiter != NULL) {
+		thread_unblock (waiter);
+		waiter = NULL;
+	}
+}
+
+/* Reads SIZE keys from the input buffer into BUF, waiting for
+   keys to be pressed as needed.  Each time it wakes up, takes
+   all the keys that have arrived, up to SIZE.  Returns SIZE. */
+size_t
+input_read (uint8_t *buf, size_t size) {
+	enum intr_level old_level;
+	size_t cnt = 0;
+
+	lock_acquire (&reader_lock);
+	while (cnt < size) {
+		old_level = intr_disable ();
+		while (ring_empty (&buffer)) {
+			waiter = thread_current ();
+			thread_block ();
+		}
+		intr_set_level (old_level);
+
+		cnt += ring_pop_many (&buffer, buf + cnt, size - cnt);
+
+		/* There is room again, so let the serial port receive. */
+		old_level = intr_disable ();
+		serial_notify ();
+		intr_set_level (old_level);
+	}
+	lock_release (&reader_lock);
+
+	return size;
 }
 
 /* Retrieves a key from the input buffer.
    If the buffer is empty, waits for a key to be pressed. */
 uint8_t
 input_getc (void) {
-	enum intr_level old_level;
 	uint8_t key;
 
-	old_level = intr_disable ();
-	key = intq_getc (&buffer);
-	serial_notify ();
-	intr_set_level (old_level);
-
+	input_read (&key, 1);
 	return key;
 }
 
@@ -44,5 +90,5 @@ input_getc (void) {
 bool
 input_full (void) {
 	ASSERT (intr_get_level () == INTR_OFF);
-	return intq_full (&buffer);
+	return ring_full (&buffer);
 }
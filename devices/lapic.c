@@ -0,0 +1,133 @@
+#include "devices/lapic.h"
+#include <debug.h>
+#include "threads/init.h"
+#include "threads/mmu.h"
+#include "threads/vaddr.h"
+#include "intrinsic.h"
+
+/* Local APIC.
+
+   Each CPU has a local APIC, which among other things contains a
+   32-bit timer that counts down at a fixed rate and can raise an
+   interrupt when it reaches zero.  Pintos still takes device
+   interrupts from the 8259A PIC, which the firmware leaves
+   connected through the local APIC in "virtual wire" mode, so the
+   only local APIC feature used here is its timer.
+
+   See [IA32-v3a] chapter 10 "Advanced Programmable Interrupt
+   Controller (APIC)". */
+
+/* IA32_APIC_BASE model-specific register. */
+#define MSR_APIC_BASE 0x1b
+#define APIC_BASE_ENABLE 0x800          /* APIC global enable. */
+#define APIC_BASE_ADDR 0xfffff000       /* Physical base address. */
+
+/* Register offsets. */
+#define REG_EOI 0x0b0                   /* End of interrupt. */
+#define REG_SVR 0x0f0                   /* Spurious interrupt vector. */
+#define REG_LVT_TIMER 0x320             /* Timer local vector table entry. */
+#define REG_TIMER_INIT 0x380            /* Timer initial count. */
+#define REG_TIMER_CUR 0x390             /* Timer current count. */
+#define REG_TIMER_DIV 0x3e0             /* Timer divide configuration. */
+
+#define SVR_ENABLE 0x100                /* APIC software enable. */
+#define LVT_MASKED 0x10000              /* Interrupt masked. */
+#define TIMER_DIV_16 0x3                /* Count once every 16 bus clocks. */
+
+/* Registers, mapped uncached, or a null pointer if there is no
+   local APIC. */
+static volatile uint32_t *lapic;
+
+static uint32_t
+lapic_read (unsigned reg) {
+	return lapic[reg / sizeof *lapic];
+}
+
+static void
+lapic_write (unsigned reg, uint32_t value) {
+	lapic[reg / sizeof *lapic] = value;
+}
+
+/* Returns true if CPUID says the CPU has a local APIC. */
+static bool
+cpu_has_apic (void) {
+	uint32_t eax = 1, ebx, ecx = 0, edx;
+
+	asm volatile ("cpuid"
+	              : "+a" (eax), "=b" (ebx), "+c" (ecx), "=d" (edx));
+	return (edx & (1 << 9)) != 0;
+}
+
+/* Maps the bootstrap processor's local APIC and enables it, with
+   the timer stopped.  Must be called after paging_init() and
+   before any user process is created, because processes copy the
+   kernel's top-level page table.  Returns false if the CPU has no
+   usable local APIC. */
+bool
+lapic_init (void) {
+	uint64_t base, pa;
+	uint64_t *pte;
+
+	if (!cpu_has_apic ())
+		return false;
+
+	base = read_msr (MSR_APIC_BASE);
+	if ((base & APIC_BASE_ENABLE) == 0)
+		return false;
+	pa = base & APIC_BASE_ADDR;
+
+	/* The registers lie far above RAM, outside the kernel's
+	   direct mapping of physical memory, so map their page
+	   there, uncached. */
+	pte = pml4e_walk (base_pml4, (uint64_t) ptov (pa), 1);
+	if (pte == NULL)
+		return false;
+	*pte = pa | PTE_P | PTE_W | PTE_PCD | PTE_PWT;
+	pml4_activate (NULL);
+	lapic = ptov (pa);
+
+	lapic_write (REG_SVR, SVR_ENABLE | LAPIC_SPURIOUS_VEC);
+	lapic_write (REG_TIMER_DIV, TIMER_DIV_16);
+	lapic_timer_stop ();
+	return true;
+}
+
+/* Returns true if lapic_init() succeeded. */
+bool
+lapic_present (void) {
+	return lapic != NULL;
+}
+
+/* Acknowledges the local APIC interrupt being handled. */
+void
+lapic_eoi (void) {
+	lapic_write (REG_EOI, 0);
+}
+
+/* Starts the timer counting down once from COUNT.  It interrupts
+   on LAPIC_TIMER_VEC when it reaches zero if INTERRUPT is true,
+   or just stops otherwise.  Restarting a running timer replaces
+   its count. */
+void
+lapic_timer_start (uint32_t count, bool interrupt) {
+	ASSERT (lapic != NULL);
+	ASSERT (count > 0);
+
+	lapic_write (REG_LVT_TIMER,
+	             LAPIC_TIMER_VEC | (interrupt ? 0 : LVT_MASKED));
+	lapic_write (REG_TIMER_INIT, count);
+}
+
+/* Stops the timer without an interrupt. */
+void
+lapic_timer_stop (void) {
+	lapic_write (REG_LVT_TIMER, LAPIC_TIMER_VEC | LVT_MASKED);
+	lapic_write (REG_TIMER_INIT, 0);
+}
+
+/* Returns what is left of the timer's count, 0 once it has run
+   out. */
+uint32_t
+lapic_timer_count (void) {
+	return lapic_read (REG_TIMER_CUR);
+}
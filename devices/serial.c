@@ -1,7 +1,7 @@
 #include "devices/serial.h"
 #include <debug.h>
+#include <ring.h>
 #include "devices/input.h"
-#include "devices/intq.h"
 #include "devices/timer.h"
 #include "threads/io.h"
 #include "threads/interrupt.h"
@@ -51,12 +51,23 @@
 /* Transmission mode. */
 static enum { UNINIT, POLL, QUEUE } mode;
 
-/* Data to be transmitted. */
-static struct intq txq;
+/* Transmit queue size, in bytes.  Must be a power of 2. */
+#define TXQ_SIZE 64
+
+/* Data to be transmitted.  serial_putc() adds to it and the
+   interrupt handler drains it.  Producers, and likewise
+   consumers, are kept from each other by disabling interrupts;
+   the console lock already keeps threads from writing at once. */
+static struct ring txq;
+static uint8_t txq_data[TXQ_SIZE];
+
+/* Thread waiting for room in TXQ, if any. */
+static struct thread *txq_waiter;
 
 static void set_serial (int bps);
 static void putc_poll (uint8_t);
 static void write_ier (void);
+static void wake_txq_waiter (void);
 static intr_handler_func serial_interrupt;
 
 /* Initializes the serial port device for polling mode.
@@ -70,7 +81,7 @@ init_poll (void) {
 	outb (FCR_REG, 0);                    /* Disable FIFO. */
 	set_serial (115200);                  /* 115.2 kbps, N-8-1. */
 	outb (MCR_REG, MCR_OUT2);             /* Required to enable interrupts. */
-	intq_init (&txq);
+	ring_init (&txq, txq_data, TXQ_SIZE, 1);
 	mode = POLL;
 }
 
@@ -106,16 +117,25 @@ serial_putc (uint8_t byte) {
 	} else {
 		/* Otherwise, queue a byte and update the interrupt enable
 		   register. */
-		if (old_level == INTR_OFF && intq_full (&txq)) {
-			/* Interrupts are off and the transmit queue is full.
-			   If we wanted to wait for the queue to empty,
-			   we'd have to reenable interrupts.
-			   That's impolite, so we'll send a character via
-			   polling instead. */
-			putc_poll (intq_getc (&txq));
+		while (ring_full (&txq)) {
+			if (old_level == INTR_OFF) {
+				/* Interrupts are off and the transmit queue is full.
+				   If we wanted to wait for the queue to empty,
+				   we'd have to reenable interrupts.
+				   That's impolite, so we'll send a character via
+				   polling instead. */
+				uint8_t c;
+				ring_pop (&txq, &c);
+				putc_poll (c);
+			} else {
+				/* Sleep until the interrupt handler makes room. */
+				ASSERT (txq_waiter == NULL);
+				txq_waiter = thread_current ();
+				thread_block ();
+			}
 		}
 
-		intq_putc (&txq, byte);
+		ring_push (&txq, &byte);
 		write_ier ();
 	}
 
@@ -127,8 +147,13 @@ serial_putc (uint8_t byte) {
 void
 serial_flush (void) {
 	enum intr_level old_level = intr_disable ();
-	while (!intq_empty (&txq))
-		putc_poll (intq_getc (&txq));
+	uint8_t buf[TXQ_SIZE];
+	size_t cnt, i;
+
+	while ((cnt = ring_pop_many (&txq, buf, sizeof buf)) > 0)
+		for (i = 0; i < cnt; i++)
+			putc_poll (buf[i]);
+	wake_txq_waiter ();
 	intr_set_level (old_level);
 }
 
@@ -171,7 +196,7 @@ write_ier (void) {
 
 	/* Enable transmit interrupt if we have any characters to
 	   transmit. */
-	if (!intq_empty (&txq))
+	if (!ring_empty (&txq))
 		ier |= IER_XMIT;
 
 	/* Enable receive interrupt if we have room to store any
@@ -182,6 +207,17 @@ write_ier (void) {
 	outb (IER_REG, ier);
 }
 
+/* Wakes up the thread waiting for room in the transmit queue, if
+   there is room now. */
+static void
+wake_txq_waiter (void) {
+	ASSERT (intr_get_level () == INTR_OFF);
+	if (txq_waiter != NULL && !ring_full (&txq)) {
+		thread_unblock (txq_waiter);
+		txq_waiter = NULL;
+	}
+}
+
 /* Polls the serial port until it's ready,
    and then transmits BYTE. */
 static void
@@ -207,8 +243,14 @@ serial_interrupt (struct intr_frame *f UNUSED) {
 
 	/* As long as we have a byte to transmit, and the hardware is
 	   ready to accept a byte for transmission, transmit a byte. */
-	while (!intq_empty (&txq) && (inb (LSR_REG) & LSR_THRE) != 0)
-		outb (THR_REG, intq_getc (&txq));
+	while ((inb (LSR_REG) & LSR_THRE) != 0) {
+		uint8_t byte;
+
+		if (!ring_pop (&txq, &byte))
+			break;
+		outb (THR_REG, byte);
+	}
+	wake_txq_waiter ();
 
 	/* Update interrupt enable register based on queue status. */
 	write_ier ();
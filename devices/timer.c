@@ -3,6 +3,7 @@
 #include <inttypes.h>
 #include <round.h>
 #include <stdio.h>
+#include "devices/hrtimer.h"
 #include "threads/interrupt.h"
 #include "threads/io.h"
 #include "threads/synch.h"
@@ -17,14 +18,71 @@
 #error TIMER_FREQ <= 1000 recommended
 #endif
 
-/* Number of timer ticks since OS booted. */
+/* 8254 input clock frequency, and input clocks per timer tick. */
+#define PIT_HZ 1193180
+#define PIT_TICK_COUNT ((PIT_HZ + TIMER_FREQ / 2) / TIMER_FREQ)
+
+/* Number of timer ticks since OS booted.  Written only by the
+	 timer interrupt; timer_ticks() reads it under TICKS_SEQLOCK
+	 instead of turning interrupts off. */
 static int64_t ticks;
+static struct seqlock ticks_seqlock;
+
+/* Dynamic tick ("-tickless").
+
+	 When enabled, idle() calls timer_idle_enter() just before
+	 halting, which reprograms the PIT from periodic mode into a
+	 single one-shot countdown that ends at the next tick on which
+	 the timing wheel has work to do.  The first interrupt of any
+	 kind afterwards calls timer_irq_enter(), which replays the
+	 ticks that went by unannounced and goes back to periodic
+	 mode, keeping the original tick phase.  The 16-bit PIT counter
+	 limits one idle stretch to TICKLESS_MAX_TICKS ticks. */
+bool timer_tickless;
+
+#define TICKLESS_MAX_TICKS (0xffff / PIT_TICK_COUNT)
+
+static int64_t tickless_ticks;			/* Ticks the one-shot spans, 0 if periodic. */
+static unsigned tickless_first;			/* PIT clocks from start to first tick. */
+static unsigned tickless_count;			/* PIT clocks programmed in total. */
+static bool tickless_restart;				/* Go periodic at the next timer interrupt? */
+static int64_t tickless_skipped;		/* Statistics: ticks replayed. */
 
 /* Number of loops per timer tick.
 	 Initialized by timer_calibrate(). */
 static unsigned loops_per_tick;
 
+/* Hierarchical timing wheel holding armed timer events.
+
+	 Level 0 has one slot per tick for events due within the next
+	 WHEEL_SIZE ticks.  Each slot of level L covers WHEEL_SIZE^L
+	 ticks; whenever the low bits of wheel_ticks for a level wrap
+	 to zero, the current slot of the next level up is "cascaded",
+	 that is, its events are reinserted one level closer to
+	 expiry.  Events further out than the top level can cover are
+	 parked in the farthest top-level slot and reinserted from
+	 there. */
+#define WHEEL_BITS 6
+#define WHEEL_SIZE (1 << WHEEL_BITS)
+#define WHEEL_MASK (WHEEL_SIZE - 1)
+#define WHEEL_LEVELS 4
+#define WHEEL_SPAN ((int64_t)1 << (WHEEL_BITS * WHEEL_LEVELS))
+
+static struct list wheel[WHEEL_LEVELS][WHEEL_SIZE];
+
+/* Next tick the timing wheel will process.  Events armed with an
+	 earlier expiry run at this tick. */
+static int64_t wheel_ticks;
+
 static intr_handler_func timer_interrupt;
+static void timer_tick(bool user);
+static void pit_periodic(void);
+static void pit_oneshot(unsigned count);
+static unsigned pit_read(void);
+static bool pit_expired(void);
+static int64_t wheel_idle_ticks(int64_t limit);
+static void wheel_insert(struct timer_event *);
+static void wheel_advance(int64_t now);
 static bool too_many_loops(unsigned loops);
 static void busy_wait(int64_t loops);
 static void real_time_sleep(int64_t num, int32_t denom);
@@ -36,13 +94,12 @@ static void real_time_sleep(int64_t num, int32_t denom);
 // 타이머 인터럽트를 시스템에 등록
 void timer_init(void)
 {
-	/* 8254 input frequency divided by TIMER_FREQ, rounded to
-		 nearest. */
-	uint16_t count = (1193180 + TIMER_FREQ / 2) / TIMER_FREQ;
+	seqlock_init(&ticks_seqlock);
+	pit_periodic();
 
-	outb(0x43, 0x34); /* CW: counter 0, LSB then MSB, mode 2, binary. */
-	outb(0x40, count & 0xff);
-	outb(0x40, count >> 8);
+	for (int level = 0; level < WHEEL_LEVELS; level++)
+		for (int slot = 0; slot < WHEEL_SIZE; slot++)
+			list_init(&wheel[level][slot]);
 
 	intr_register_ext(0x20, timer_interrupt, "8254 Timer");
 }
@@ -80,9 +137,14 @@ void timer_calibrate(void)
 int64_t
 timer_ticks(void)
 {
-	enum intr_level old_level = intr_disable();
-	int64_t t = ticks;
-	intr_set_level(old_level);
+	unsigned seq;
+	int64_t t;
+
+	do
+	{
+		seq = seqlock_read_begin(&ticks_seqlock);
+		t = ticks;
+	} while (seqlock_read_retry(&ticks_seqlock, seq));
 	barrier();
 	return t;
 }
@@ -141,29 +203,308 @@ void timer_nsleep(int64_t ns)
 void timer_print_stats(void)
 {
 	printf("Timer: %" PRId64 " ticks\n", timer_ticks());
+	if (timer_tickless)
+		printf("Timer: %" PRId64 " ticks skipped while idle\n", tickless_skipped);
+}
+
+/* Called by idle() with interrupts off, right before halting.
+	 In tickless mode, stops the periodic tick until the next tick
+	 that has timer events due, if that is at least two ticks
+	 away. */
+void timer_idle_enter(void)
+{
+	unsigned first;
+	int64_t n;
+
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	if (!timer_tickless || tickless_ticks != 0 || tickless_restart
+			|| hrtimer_needs_tick())
+		return;
+
+	n = wheel_idle_ticks(TICKLESS_MAX_TICKS);
+	if (n < 2)
+		return;
+
+	/* Count down what is left of the current period, then N - 1
+		 full periods, so the one-shot ends on a tick boundary. */
+	first = pit_read();
+	if (first == 0 || first > PIT_TICK_COUNT)
+		first = PIT_TICK_COUNT;
+	tickless_first = first;
+	tickless_count = first + (n - 1) * PIT_TICK_COUNT;
+	tickless_ticks = n;
+	pit_oneshot(tickless_count);
+}
+
+/* Called by intr_handler() on entry to every external interrupt.
+	 If the periodic tick was stopped by timer_idle_enter(), replays
+	 the ticks that elapsed since then and restarts it. */
+void timer_irq_enter(void)
+{
+	int64_t n = tickless_ticks;
+	int64_t elapsed_ticks;
+
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	if (n == 0)
+		return;
+	tickless_ticks = 0;
+
+	if (pit_expired())
+	{
+		/* The one-shot ran out.  Its interrupt is being delivered
+			 now or is pending, and timer_interrupt() will count the
+			 last tick itself. */
+		elapsed_ticks = n - 1;
+		pit_periodic();
+	}
+	else
+	{
+		/* Woken early by another device.  Count the tick boundaries
+			 crossed so far, then count down to the next boundary in
+			 one-shot mode, switching back to periodic mode from
+			 timer_interrupt() there.  Going straight to mode 2 here
+			 would raise the counter's output and deliver a spurious
+			 tick. */
+		unsigned elapsed = tickless_count - pit_read();
+		unsigned next;
+
+		elapsed_ticks = elapsed < tickless_first
+												? 0
+												: 1 + (elapsed - tickless_first) / PIT_TICK_COUNT;
+		next = tickless_first + elapsed_ticks * PIT_TICK_COUNT - elapsed;
+		pit_oneshot(next > 0 ? next : 1);
+		tickless_restart = true;
+	}
+
+	tickless_skipped += elapsed_ticks;
+	while (elapsed_ticks-- > 0)
+		timer_tick(false);
 }
 
 /* Timer interrupt handler. */
 // 타이머 인터럽트가 발생할 때마다 호출되어 'ticks' 변수를 증가시키고, 스레드 관리자를 통해 스레드의 타이밍을 조정
 static void
-timer_interrupt(struct intr_frame *args UNUSED)
+timer_interrupt(struct intr_frame *args)
+{
+	if (tickless_restart)
+	{
+		tickless_restart = false;
+		pit_periodic();
+	}
+	timer_tick((args->cs & 3) == 3);
+}
+
+/* Accounts for one timer tick: advances the tick count, updates
+	 scheduler statistics and runs the timer events that are due.
+	 USER is true if the tick interrupted user mode.
+	 Runs in external interrupt context. */
+static void
+timer_tick(bool user)
 {
+	seqlock_write_begin(&ticks_seqlock);
 	ticks++;
-	thread_tick();
-	if (thread_mlfqs)
+	seqlock_write_end(&ticks_seqlock);
+	thread_tick(user);
+	wheel_advance(ticks);
+	hrtimer_tick();
+}
+
+/* Programs PIT counter 0 to interrupt TIMER_FREQ times per
+	 second. */
+static void
+pit_periodic(void)
+{
+	outb(0x43, 0x34); /* CW: counter 0, LSB then MSB, mode 2, binary. */
+	outb(0x40, PIT_TICK_COUNT & 0xff);
+	outb(0x40, PIT_TICK_COUNT >> 8);
+}
+
+/* Programs PIT counter 0 to interrupt once, COUNT input clocks
+	 from now. */
+static void
+pit_oneshot(unsigned count)
+{
+	ASSERT(count > 0 && count <= 0xffff);
+
+	outb(0x43, 0x30); /* CW: counter 0, LSB then MSB, mode 0, binary. */
+	outb(0x40, count & 0xff);
+	outb(0x40, count >> 8);
+}
+
+/* Returns the current value of PIT counter 0. */
+static unsigned
+pit_read(void)
+{
+	unsigned lo, hi;
+
+	outb(0x43, 0x00); /* Counter latch command for counter 0. */
+	lo = inb(0x40);
+	hi = inb(0x40);
+	return lo | (hi << 8);
+}
+
+/* Returns true if a one-shot countdown on PIT counter 0 has
+	 reached zero, according to the counter's output pin. */
+static bool
+pit_expired(void)
+{
+	outb(0x43, 0xe2); /* Read-back: status only, counter 0. */
+	return (inb(0x40) & 0x80) != 0;
+}
+
+/* Initializes EVENT as an unarmed timer event that calls
+	 FUNC(AUX) when it expires. */
+void timer_event_init(struct timer_event *event, timer_func *func, void *aux)
+{
+	ASSERT(event != NULL);
+	ASSERT(func != NULL);
+
+	event->func = func;
+	event->aux = aux;
+	event->expires = 0;
+	event->armed = false;
+}
+
+/* Arms EVENT to expire at tick EXPIRES, as returned by
+	 timer_ticks().  If EXPIRES has already passed, the event
+	 expires at the next timer tick.  Re-arming a pending event
+	 moves its expiry. */
+void timer_arm(struct timer_event *event, int64_t expires)
+{
+	enum intr_level old_level = intr_disable();
+
+	if (event->armed)
+		list_remove(&event->elem);
+	event->expires = expires;
+	event->armed = true;
+	wheel_insert(event);
+
+	intr_set_level(old_level);
+}
+
+/* Disarms EVENT.  Returns true if it was pending, false if it
+	 had already expired or was never armed. */
+bool timer_cancel(struct timer_event *event)
+{
+	enum intr_level old_level = intr_disable();
+	bool was_armed = event->armed;
+
+	if (was_armed)
 	{
-		mlfqs_increment_recent_cpu();
-		if (ticks % 4 == 0)
+		list_remove(&event->elem);
+		event->armed = false;
+	}
+
+	intr_set_level(old_level);
+	return was_armed;
+}
+
+/* Returns true if EVENT is armed and has not yet expired. */
+bool timer_pending(const struct timer_event *event)
+{
+	return event->armed;
+}
+
+/* Returns the number of ticks from now until the next tick at
+	 which the timing wheel has events to run or to cascade, or
+	 LIMIT if that is further away. */
+static int64_t
+wheel_idle_ticks(int64_t limit)
+{
+	int64_t t;
+
+	for (t = wheel_ticks; t < ticks + limit; t++)
+		if ((t & WHEEL_MASK) == 0 || !list_empty(&wheel[0][t & WHEEL_MASK]))
+			break;
+	return t - ticks;
+}
+
+/* Puts armed EVENT into the wheel slot for its expiry, relative
+	 to wheel_ticks. */
+static void
+wheel_insert(struct timer_event *event)
+{
+	int64_t expires = event->expires;
+	int64_t delta = expires - wheel_ticks;
+	int level;
+
+	if (delta < 0)
+	{
+		/* Overdue: run at the next tick processed. */
+		delta = 0;
+		expires = wheel_ticks;
+	}
+	else if (delta >= WHEEL_SPAN)
+	{
+		/* Too far out: park in the farthest slot for now. */
+		delta = WHEEL_SPAN - 1;
+		expires = wheel_ticks + delta;
+	}
+
+	for (level = 0; level < WHEEL_LEVELS - 1; level++)
+		if (delta < (int64_t)1 << (WHEEL_BITS * (level + 1)))
+			break;
+
+	list_push_back(&wheel[level][(expires >> (WHEEL_BITS * level)) & WHEEL_MASK],
+								 &event->elem);
+}
+
+/* Moves every event in SLOT onto the initially empty list DST. */
+static void
+wheel_detach(struct list *slot, struct list *dst)
+{
+	if (!list_empty(slot))
+		list_splice(list_end(dst), list_begin(slot), list_end(slot));
+}
+
+/* Reinserts the events in wheel slot (LEVEL, SLOT) at their
+	 proper, lower, level.  Returns SLOT, so that the caller knows
+	 whether the next level wrapped too. */
+static int
+wheel_cascade(int level, int slot)
+{
+	struct list events;
+
+	list_init(&events);
+	wheel_detach(&wheel[level][slot], &events);
+	while (!list_empty(&events))
+		wheel_insert(list_entry(list_pop_front(&events), struct timer_event, elem));
+	return slot;
+}
+
+/* Runs the callbacks of all events due at or before tick NOW. */
+static void
+wheel_advance(int64_t now)
+{
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	while (wheel_ticks <= now)
+	{
+		int slot = wheel_ticks & WHEEL_MASK;
+		struct list expired;
+
+		/* Pull the next level's events down each time this one wraps. */
+		for (int level = 1; slot == 0 && level < WHEEL_LEVELS; level++)
+			if (wheel_cascade(level, (wheel_ticks >> (WHEEL_BITS * level)) & WHEEL_MASK) != 0)
+				break;
+
+		/* Detach the slot before running callbacks, so that events
+			 re-armed by a callback cannot land in the list being
+			 drained. */
+		list_init(&expired);
+		wheel_detach(&wheel[0][slot], &expired);
+		wheel_ticks++;
+
+		while (!list_empty(&expired))
 		{
-			mlfqs_recalculate_priority();
-			if (ticks % TIMER_FREQ == 0) // TIMER_FREQ : 1초에 몇 개의 ticks가 실행되는지 (초기값 : 100)
-			{
-				mlfqs_recalculate_recent_cpu();
-				mlfqs_calculate_load_avg();
-			}
+			struct timer_event *event =
+					list_entry(list_pop_front(&expired), struct timer_event, elem);
+			event->armed = false;
+			event->func(event->aux);
 		}
 	}
-	thread_wake_up(ticks);
 }
 
 /* Returns true if LOOPS iterations waits for more than one timer
@@ -214,7 +555,15 @@ real_time_sleep(int64_t num, int32_t denom)
 	int64_t ticks = num * TIMER_FREQ / denom;
 
 	ASSERT(intr_get_level() == INTR_ON);
-	if (ticks > 0)
+	if (hrtimer_available())
+	{
+		/* Block on a high-resolution timer, at any granularity.
+			 DENOM always divides a second evenly. */
+		ASSERT(1000 * 1000 * 1000 % denom == 0);
+		if (num > 0)
+			hrtimer_sleep(num * (1000 * 1000 * 1000 / denom));
+	}
+	else if (ticks > 0)
 	{
 		/* We're waiting for at least one full timer tick.  Use
 			 timer_sleep() because it will yield the CPU to other
@@ -224,8 +573,9 @@ real_time_sleep(int64_t num, int32_t denom)
 	else
 	{
 		/* Otherwise, use a busy-wait loop for more accurate
-			 sub-tick timing.  We scale the numerator and denominator
-			 down by 1000 to avoid the possibility of overflow. */
+			 sub-tick timing.  Only happens before hrtimer_init().
+			 We scale the numerator and denominator down by 1000 to
+			 avoid the possibility of overflow. */
 		ASSERT(denom % 1000 == 0);
 		busy_wait(loops_per_tick * num / 1000 * TIMER_FREQ / (denom / 1000));
 	}
@@ -0,0 +1,47 @@
+#ifndef DEVICES_HRTIMER_H
+#define DEVICES_HRTIMER_H
+
+#include <heap.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "devices/timer.h"
+
+/* High-resolution timers.
+
+   hrtimer_now() is a monotonic clock in nanoseconds since boot,
+   read from the CPU's time stamp counter.  High-resolution timer
+   events are like the tick-based events in timer.h, but expire at
+   a nanosecond deadline on that clock: the earliest pending event
+   is programmed into the local APIC timer in one-shot mode, so it
+   fires when it is due rather than at the next timer tick.  Their
+   callbacks run under the same rules as tick-based ones.
+
+   Both need calibrating against the timer tick first, which
+   hrtimer_init() does.  Without a local APIC, events still work
+   but expire on the first timer tick at or after their
+   deadline. */
+
+struct hrtimer_event {
+	struct heap_elem elem;      /* Element in the pending heap. */
+	int64_t expires;            /* hrtimer_now() at which FUNC runs. */
+	timer_func *func;           /* Callback. */
+	void *aux;                  /* Callback argument. */
+	bool armed;                 /* Pending? */
+};
+
+void hrtimer_init (void);
+bool hrtimer_available (void);
+int64_t hrtimer_now (void);
+
+void hrtimer_event_init (struct hrtimer_event *, timer_func *, void *aux);
+void hrtimer_arm (struct hrtimer_event *, int64_t expires);
+bool hrtimer_cancel (struct hrtimer_event *);
+bool hrtimer_pending (const struct hrtimer_event *);
+
+void hrtimer_sleep (int64_t ns);
+void hrtimer_sleep_until (int64_t deadline);
+
+void hrtimer_tick (void);
+bool hrtimer_needs_tick (void);
+
+#endif /* devices/hrtimer.h */
@@ -0,0 +1,23 @@
+#ifndef DEVICES_LAPIC_H
+#define DEVICES_LAPIC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Interrupt vectors delivered by the local APIC.  intr_handler()
+   treats LAPIC_VEC_MIN through LAPIC_VEC_MAX as external
+   interrupts and acknowledges them with lapic_eoi(). */
+#define LAPIC_VEC_MIN 0xf0
+#define LAPIC_TIMER_VEC 0xf0            /* Local APIC timer. */
+#define LAPIC_VEC_MAX 0xfe
+#define LAPIC_SPURIOUS_VEC 0xff         /* Spurious interrupts, never acked. */
+
+bool lapic_init (void);
+bool lapic_present (void);
+void lapic_eoi (void);
+
+void lapic_timer_start (uint32_t count, bool interrupt);
+void lapic_timer_stop (void);
+uint32_t lapic_timer_count (void);
+
+#endif /* devices/lapic.h */
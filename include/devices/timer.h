@@ -1,7 +1,9 @@
 #ifndef DEVICES_TIMER_H
 #define DEVICES_TIMER_H
 
+#include <list.h>
 #include <round.h>
+#include <stdbool.h>
 #include <stdint.h>
 
 /* Number of timer interrupts per second. */
@@ -20,4 +22,32 @@ void timer_nsleep (int64_t nanoseconds);
 
 void timer_print_stats (void);
 
+/* Dynamic tick. */
+extern bool timer_tickless;
+void timer_idle_enter (void);
+void timer_irq_enter (void);
+
+/* One-shot timer events.
+
+   A timer event calls FUNC(AUX) from the timer interrupt handler
+   once timer_ticks() reaches its expiry tick.  The callback runs
+   in an external interrupt context with interrupts off, so it
+   must not sleep; it may arm or cancel timer events, including
+   its own.  Events are kept in a hierarchical timing wheel, so
+   arming, canceling and expiring an event take constant time. */
+typedef void timer_func (void *aux);
+
+struct timer_event {
+	struct list_elem elem;      /* Timing wheel slot element. */
+	int64_t expires;            /* Tick at which FUNC runs. */
+	timer_func *func;           /* Callback. */
+	void *aux;                  /* Callback argument. */
+	bool armed;                 /* Pending in the timing wheel? */
+};
+
+void timer_event_init (struct timer_event *, timer_func *, void *aux);
+void timer_arm (struct timer_event *, int64_t expires);
+bool timer_cancel (struct timer_event *);
+bool timer_pending (const struct timer_event *);
+
 #endif /* devices/timer.h */
@@ -119,6 +119,21 @@ static __inline uint64_t rcr2(void) {
 	return val;
 }
 
+__attribute__((always_inline))
+static __inline uint64_t read_msr(uint32_t ecx) {
+	uint32_t edx, eax;
+	__asm __volatile("rdmsr" : "=d" (edx), "=a" (eax) : "c" (ecx));
+	return ((uint64_t) edx << 32) | eax;
+}
+
+/* Returns the time stamp counter. */
+__attribute__((always_inline))
+static __inline uint64_t rdtsc(void) {
+	uint32_t edx, eax;
+	__asm __volatile("rdtsc" : "=d" (edx), "=a" (eax));
+	return ((uint64_t) edx << 32) | eax;
+}
+
 __attribute__((always_inline))
 static __inline void write_msr(uint32_t ecx, uint64_t val) {
 	uint32_t edx, eax;
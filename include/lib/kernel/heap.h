@@ -0,0 +1,62 @@
+#ifndef __LIB_KERNEL_HEAP_H
+#define __LIB_KERNEL_HEAP_H
+
+/* Priority queue.
+ *
+ * This is an intrusive pairing heap: like the doubly linked list
+ * in list.h, it stores no data of its own and instead links
+ * together `struct heap_elem's embedded in the caller's
+ * structures.  heap_entry() converts an element back into its
+ * containing structure, exactly as list_entry() does.
+ *
+ * Elements are ordered by a caller-supplied comparison function.
+ * heap_min() takes constant time, heap_insert() takes constant
+ * time, and heap_pop_min() and heap_remove() take O(lg n)
+ * amortized time.  Unlike a binary heap kept in an array, a
+ * pairing heap never allocates memory, so it may be used with
+ * interrupts disabled and from interrupt handlers. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Heap element. */
+struct heap_elem {
+	struct heap_elem *child;        /* Leftmost child. */
+	struct heap_elem *next;         /* Next sibling to the right. */
+	struct heap_elem *prev;         /* Left sibling, or parent if leftmost. */
+};
+
+/* Converts pointer to heap element HEAP_ELEM into a pointer to
+   the structure that HEAP_ELEM is embedded inside.  Supply the
+   name of the outer structure STRUCT and the member name MEMBER
+   of the heap element. */
+#define heap_entry(HEAP_ELEM, STRUCT, MEMBER)           \
+	((STRUCT *) ((uint8_t *) &(HEAP_ELEM)->child     \
+		- offsetof (STRUCT, MEMBER.child)))
+
+/* Compares the value of two heap elements A and B, given
+   auxiliary data AUX.  Returns true if A should come out of the
+   heap before B. */
+typedef bool heap_less_func (const struct heap_elem *a,
+                             const struct heap_elem *b,
+                             void *aux);
+
+/* Heap. */
+struct heap {
+	struct heap_elem *root;         /* Minimum element, or NULL. */
+	size_t size;                    /* Number of elements. */
+	heap_less_func *less;           /* Comparison function. */
+	void *aux;                      /* Auxiliary data for `less'. */
+};
+
+void heap_init (struct heap *, heap_less_func *, void *aux);
+bool heap_empty (const struct heap *);
+size_t heap_size (const struct heap *);
+
+void heap_insert (struct heap *, struct heap_elem *);
+struct heap_elem *heap_min (const struct heap *);
+struct heap_elem *heap_pop_min (struct heap *);
+void heap_remove (struct heap *, struct heap_elem *);
+
+#endif /* lib/kernel/heap.h */
@@ -0,0 +1,76 @@
+#ifndef __LIB_KERNEL_RBTREE_H
+#define __LIB_KERNEL_RBTREE_H
+
+/* Red-black tree.
+ *
+ * This is an intrusive balanced binary search tree: like the
+ * doubly linked list in list.h, it links together `struct
+ * rb_elem's embedded in the caller's structures, and
+ * rb_entry() converts an element back into its containing
+ * structure.
+ *
+ * Elements are ordered by a caller-supplied comparison function.
+ * Elements that compare equal are kept in insertion order.
+ * rbtree_insert() and rbtree_remove() take O(lg n) time.  The
+ * tree caches its leftmost element, so rbtree_first() takes
+ * constant time, which makes the tree usable as a priority queue
+ * that also supports in-order iteration:
+ *
+ *      struct rb_elem *e;
+ *
+ *      for (e = rbtree_first (&tree); e != NULL; e = rbtree_next (e))
+ *        {
+ *          struct foo *f = rb_entry (e, struct foo, elem);
+ *          ...do something with f...
+ *        }
+ *
+ * The tree never allocates memory, so it may be used with
+ * interrupts disabled and from interrupt handlers. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Red-black tree element. */
+struct rb_elem {
+	struct rb_elem *parent;         /* Parent, or NULL at the root. */
+	struct rb_elem *left;           /* Left child, or NULL. */
+	struct rb_elem *right;          /* Right child, or NULL. */
+	bool red;                       /* Red or black? */
+};
+
+/* Converts pointer to tree element RB_ELEM into a pointer to the
+   structure that RB_ELEM is embedded inside.  Supply the name of
+   the outer structure STRUCT and the member name MEMBER of the
+   tree element. */
+#define rb_entry(RB_ELEM, STRUCT, MEMBER)               \
+	((STRUCT *) ((uint8_t *) &(RB_ELEM)->parent      \
+		- offsetof (STRUCT, MEMBER.parent)))
+
+/* Compares the value of two tree elements A and B, given
+   auxiliary data AUX.  Returns true if A is less than B, or
+   false if A is greater than or equal to B. */
+typedef bool rb_less_func (const struct rb_elem *a,
+                           const struct rb_elem *b,
+                           void *aux);
+
+/* Red-black tree. */
+struct rbtree {
+	struct rb_elem *root;           /* Root, or NULL if empty. */
+	struct rb_elem *first;          /* Leftmost element, or NULL. */
+	size_t size;                    /* Number of elements. */
+	rb_less_func *less;             /* Comparison function. */
+	void *aux;                      /* Auxiliary data for `less'. */
+};
+
+void rbtree_init (struct rbtree *, rb_less_func *, void *aux);
+bool rbtree_empty (const struct rbtree *);
+size_t rbtree_size (const struct rbtree *);
+
+void rbtree_insert (struct rbtree *, struct rb_elem *);
+void rbtree_remove (struct rbtree *, struct rb_elem *);
+
+struct rb_elem *rbtree_first (const struct rbtree *);
+struct rb_elem *rbtree_next (const struct rb_elem *);
+
+#endif /* lib/kernel/rbtree.h */
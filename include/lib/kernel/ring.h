@@ -0,0 +1,47 @@
+#ifndef __LIB_KERNEL_RING_H
+#define __LIB_KERNEL_RING_H
+
+/* Single-producer, single-consumer ring buffer.
+ *
+ * A ring holds up to a power-of-2 number of fixed-size elements
+ * in an array supplied by the caller.  One thread or interrupt
+ * handler may add elements while another removes them, with no
+ * lock and without disabling interrupts: only the producer
+ * writes `head' and only the consumer writes `tail'.  Each side
+ * publishes its index with a release store after it has touched
+ * the elements, and reads the other side's index with an acquire
+ * load, so the consumer never sees an index before the data
+ * behind it, and the producer never overwrites an element the
+ * consumer is still reading.
+ *
+ * Several producers, or several consumers, must be serialized by
+ * the caller, for example with a lock or by disabling
+ * interrupts.  ring_push_many() and ring_pop_many() move as many
+ * elements as fit with a single index update. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Ring buffer. */
+struct ring {
+	uint8_t *buf;                   /* Elements. */
+	size_t elem_size;               /* Size of an element, in bytes. */
+	size_t mask;                    /* Capacity minus 1. */
+	size_t head;                    /* Elements ever added. */
+	size_t tail;                    /* Elements ever removed. */
+};
+
+void ring_init (struct ring *, void *buf, size_t cnt, size_t elem_size);
+size_t ring_capacity (const struct ring *);
+size_t ring_count (const struct ring *);
+size_t ring_space (const struct ring *);
+bool ring_empty (const struct ring *);
+bool ring_full (const struct ring *);
+
+bool ring_push (struct ring *, const void *elem);
+bool ring_pop (struct ring *, void *elem);
+size_t ring_push_many (struct ring *, const void *elems, size_t cnt);
+size_t ring_pop_many (struct ring *, void *elems, size_t cnt);
+
+#endif /* lib/kernel/ring.h */
@@ -0,0 +1,21 @@
+#ifndef __LIB_RUSAGE_H
+#define __LIB_RUSAGE_H
+
+/* Resource usage, as reported by the getrusage system call.
+   Times are in timer ticks. */
+struct rusage {
+	long long ru_utime;             /* Ticks running in user mode. */
+	long long ru_stime;             /* Ticks running in kernel mode. */
+	long long ru_wtime;             /* Ticks ready to run but not running. */
+	long long ru_nvcsw;             /* Context switches from blocking. */
+	long long ru_nivcsw;            /* Context switches from preemption. */
+	long long ru_faults;            /* Page faults. */
+	long long ru_inbytes;           /* Bytes read by the read call. */
+	long long ru_outbytes;          /* Bytes written by the write call. */
+};
+
+/* Whose usage getrusage() reports. */
+#define RUSAGE_SELF 0           /* The calling process. */
+#define RUSAGE_CHILDREN (-1)    /* Its children that have been waited for. */
+
+#endif /* lib/rusage.h */
@@ -36,6 +36,20 @@ enum {
 
 	SYS_MOUNT,
 	SYS_UMOUNT,
+
+	/* Scheduling. */
+	SYS_SET_TICKETS,            /* Set stride scheduler tickets. */
+	SYS_GETRUSAGE,              /* Get resource usage. */
+
+	/* Synchronization. */
+	SYS_FUTEX_WAIT,             /* Sleep while a word holds a value. */
+	SYS_FUTEX_WAKE,             /* Wake threads sleeping on a word. */
+
+	/* User threads. */
+	SYS_THREAD_CREATE,          /* Start a thread in this process. */
+	SYS_THREAD_JOIN,            /* Wait for a thread to finish. */
+	SYS_THREAD_EXIT,            /* Finish the calling thread. */
+	SYS_SET_TLS,                /* Set the thread-local storage pointer. */
 };
 
 #endif /* lib/syscall-nr.h */
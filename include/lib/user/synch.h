@@ -0,0 +1,35 @@
+#ifndef __LIB_USER_SYNCH_H
+#define __LIB_USER_SYNCH_H
+
+#include <stdbool.h>
+
+/* Mutexes and condition variables for user programs, built on
+   futex_wait() and futex_wake().  Locking a free mutex and
+   signaling a condition nobody waits on never enter the kernel. */
+
+/* Mutex. */
+struct mutex {
+	int state;                  /* 0: free, 1: locked, 2: contended. */
+};
+
+#define MUTEX_INITIALIZER { 0 }
+
+void mutex_init (struct mutex *);
+void mutex_lock (struct mutex *);
+bool mutex_trylock (struct mutex *);
+void mutex_unlock (struct mutex *);
+
+/* Condition variable. */
+struct condvar {
+	int seq;                    /* Bumped by every signal. */
+	int waiters;                /* Number of waiting threads. */
+};
+
+#define CONDVAR_INITIALIZER { 0, 0 }
+
+void condvar_init (struct condvar *);
+void condvar_wait (struct condvar *, struct mutex *);
+void condvar_signal (struct condvar *);
+void condvar_broadcast (struct condvar *);
+
+#endif /* lib/user/synch.h */
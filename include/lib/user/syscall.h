@@ -3,12 +3,17 @@
 
 #include <stdbool.h>
 #include <debug.h>
+#include <rusage.h>
 #include <stddef.h>
 
 /* Process identifier. */
 typedef int pid_t;
 #define PID_ERROR ((pid_t) -1)
 
+/* Thread identifier. */
+typedef int tid_t;
+#define TID_ERROR ((tid_t) -1)
+
 /* Map region identifier. */
 typedef int off_t;
 #define MAP_FAILED ((void *) NULL)
@@ -38,6 +43,21 @@ void close (int fd);
 
 int dup2(int oldfd, int newfd);
 
+/* Scheduling. */
+int set_tickets (int tickets);
+int getrusage (int who, struct rusage *usage);
+
+/* Synchronization. */
+int futex_wait (int *addr, int expected, int timeout);
+int futex_wake (int *addr, int count);
+
+/* User threads. */
+tid_t thread_create (void (*entry) (void *, void *), void *arg0, void *arg1,
+                     void *stack, void *tls);
+int thread_join (tid_t);
+void thread_exit (int status) NO_RETURN;
+void set_tls (void *tls);
+
 /* Project 3 and optionally project 4. */
 void *mmap (void *addr, size_t length, int writable, int fd, off_t offset);
 void munmap (void *addr);
@@ -0,0 +1,37 @@
+#ifndef __LIB_USER_UTHREAD_H
+#define __LIB_USER_UTHREAD_H
+
+#include <debug.h>
+#include <syscall.h>
+
+/* User threads.
+
+   Threads started with uthread_create() run in the same address
+   space as the rest of the process and share its open files.
+   Each has its own stack, taken from a fixed pool, and its own
+   thread-local storage block, reached through the FS segment.
+   Use the mutexes and condition variables in <synch.h> to
+   synchronize them.
+
+   exit() in any thread ends the whole process.  Returning from
+   a thread's function, or calling uthread_exit(), ends only that
+   thread, except in the initial thread, where it ends the
+   process. */
+
+/* Maximum number of threads alive at once, not counting the
+   initial one. */
+#define UTHREAD_MAX 8
+
+/* Size of each thread's stack. */
+#define UTHREAD_STACK_SIZE (8 * 1024)
+
+typedef int uthread_func (void *aux);
+
+tid_t uthread_create (uthread_func *, void *aux);
+int uthread_join (tid_t);
+void uthread_exit (int status) NO_RETURN;
+
+void *uthread_get_local (void);
+void uthread_set_local (void *);
+
+#endif /* lib/user/uthread.h */
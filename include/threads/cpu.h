@@ -0,0 +1,61 @@
+#ifndef THREADS_CPU_H
+#define THREADS_CPU_H
+
+#include <heap.h>
+#include <list.h>
+#include <rbtree.h>
+#include <stdbool.h>
+#include "threads/runqueue.h"
+#include "threads/synch.h"
+
+/* Maximum number of CPUs the scheduler can manage. */
+#define MAX_CPUS 16
+
+/* Per-CPU scheduler state.
+ *
+ * Each CPU schedules from its own run queue, guarded by its own
+ * spinlock.  Interrupts must be off while any of these members
+ * are used, because disabling interrupts is what keeps the
+ * running thread from moving to another CPU.
+ *
+ * Only the bootstrap processor, cpus[0], is ever started, so
+ * cpu_cnt is 1 and a thread always waits on the run queue of
+ * the CPU it last ran on.  Application processors are not
+ * brought up: the rest of the kernel (semaphores, palloc,
+ * malloc, the file system) still relies on disabling interrupts
+ * for mutual exclusion, which does not exclude other CPUs. */
+struct cpu {
+	int id;                         /* Index into cpus[]. */
+	struct thread *curr;            /* Thread running on this CPU. */
+	struct thread *idle_thread;     /* Runs when the run queue is empty. */
+
+	/* Run queue.  The scheduling class decides which of these
+	   structures holds the ready threads. */
+	struct spinlock rq_lock;        /* Protects the run queue members. */
+	size_t nr_ready;                /* Number of threads ready to run here. */
+	struct runqueue rq;             /* Priority and MLFQS classes. */
+	struct heap stride_rq;          /* Stride class, ordered by pass. */
+	int64_t stride_vtime;           /* Stride class: pass of last pick. */
+	struct rbtree cfs_rq;           /* CFS class, ordered by vruntime. */
+	int64_t cfs_min_vruntime;       /* CFS class: monotonic vruntime floor. */
+	long cfs_load;                  /* CFS class: total weight of cfs_rq. */
+	struct heap edf_rq;             /* EDF class, ordered by deadline. */
+
+	unsigned thread_ticks;          /* # of timer ticks since last yield. */
+	struct list destruction_req;    /* Dying threads to free. */
+
+	/* Statistics. */
+	long long idle_ticks;           /* # of timer ticks spent idle. */
+	long long kernel_ticks;         /* # of timer ticks in kernel threads. */
+	long long user_ticks;           /* # of timer ticks in user programs. */
+	long long dl_jobs;              /* # of EDF periods started. */
+	long long dl_misses;            /* # of EDF deadlines missed. */
+	long long dl_throttles;         /* # of times EDF budget ran out. */
+};
+
+extern struct cpu cpus[MAX_CPUS];
+extern int cpu_cnt;
+
+struct cpu *this_cpu (void);
+
+#endif /* threads/cpu.h */
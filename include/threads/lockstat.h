@@ -0,0 +1,56 @@
+#ifndef THREADS_LOCKSTAT_H
+#define THREADS_LOCKSTAT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Lock contention profiling ("-lockstat").
+
+   Locks initialized with lock_init_named(), rwlock_init_named() or
+   spinlock_init_named() get a struct lock_stats.  When profiling
+   is on, acquiring and releasing the lock feed it: how often the
+   lock was acquired and how often it had to be waited for, how
+   long waits and holds took, and which callers waited the most.
+   A spinlock's waits are the time spent spinning.  Readers of a
+   readers-writer lock count toward acquisitions and waits but not
+   hold times.  Statistics are printed at power-off.
+
+   A lock that goes away before power-off, such as the lock of a
+   destroyed slab cache, must give its statistics back with
+   lockstat_unregister(). */
+
+/* Number of waiting call sites remembered per lock. */
+#define LOCKSTAT_CALLERS 4
+
+/* A call site that waited for a lock. */
+struct lockstat_caller {
+	void *addr;                 /* Return address into the caller. */
+	long long waits;            /* Number of waits from there. */
+	int64_t wait_time;          /* Total wait time there, in ns. */
+};
+
+/* Statistics for one named lock. */
+struct lock_stats {
+	bool in_use;                /* Registered to a live lock? */
+	char name[16];              /* Name given at initialization. */
+	long long acquired;         /* Number of acquisitions. */
+	long long contended;        /* Number that had to wait. */
+	int64_t wait_time;          /* Total wait time, in ns. */
+	int64_t wait_max;           /* Longest wait, in ns. */
+	int64_t hold_time;          /* Total hold time, in ns. */
+	int64_t hold_max;           /* Longest hold, in ns. */
+	int64_t hold_start;         /* When the current holder got it. */
+	struct lockstat_caller callers[LOCKSTAT_CALLERS];
+};
+
+extern bool lockstat_enabled;
+
+struct lock_stats *lockstat_register (const char *name);
+void lockstat_unregister (struct lock_stats *);
+int64_t lockstat_now (void);
+void lockstat_acquired (struct lock_stats *, int64_t wait_start,
+                        void *caller, bool hold);
+void lockstat_released (struct lock_stats *);
+void lockstat_print_stats (void);
+
+#endif /* threads/lockstat.h */
@@ -0,0 +1,39 @@
+#ifndef THREADS_RUNQUEUE_H
+#define THREADS_RUNQUEUE_H
+
+#include <list.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "threads/thread.h"
+
+/* Number of distinct priority levels, PRI_MIN through PRI_MAX. */
+#define PRI_CNT (PRI_MAX - PRI_MIN + 1)
+
+/* A run queue of THREAD_READY threads.
+ *
+ * Ready threads are kept in one FIFO list per priority level, and
+ * the set of nonempty levels is tracked in a 64-bit bitmap, so that
+ * inserting a thread, removing a thread and finding the
+ * highest-priority ready thread all take constant time.  Threads of
+ * equal priority are served round-robin in the order they were
+ * pushed.
+ *
+ * A queued thread remembers the level it was queued at in its
+ * `rq_priority' member, so its `priority' may be changed only after
+ * taking it off the queue; see thread_update_priority(). */
+struct runqueue {
+	uint64_t bitmap;                /* Bit P is set iff queues[P] is nonempty. */
+	struct list queues[PRI_CNT];    /* One FIFO of threads per priority. */
+	size_t size;                    /* Number of queued threads. */
+};
+
+void runqueue_init (struct runqueue *);
+bool runqueue_empty (const struct runqueue *);
+size_t runqueue_size (const struct runqueue *);
+int runqueue_max_priority (const struct runqueue *);
+void runqueue_push (struct runqueue *, struct thread *);
+void runqueue_remove (struct runqueue *, struct thread *);
+struct thread *runqueue_pop (struct runqueue *);
+
+#endif /* threads/runqueue.h */
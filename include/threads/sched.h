@@ -0,0 +1,90 @@
+#ifndef THREADS_SCHED_H
+#define THREADS_SCHED_H
+
+#include <stdbool.h>
+#include "threads/cpu.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+/* # of timer ticks to give each thread before preempting it in
+   favor of another one the class considers equally deserving. */
+#define TIME_SLICE 4
+
+/* A scheduling class: the policy half of the scheduler.
+ *
+ * thread.c provides the mechanism -- blocking and waking threads,
+ * switching contexts -- and leaves every policy decision to the
+ * class chosen at boot, thread_sched.  Adding a scheduling policy
+ * means writing one of these; synch.c and the timer never look at
+ * which policy is running.
+ *
+ * Threads that register a deadline with thread_set_deadline()
+ * move to sched_edf_class, whose run queue thread.c always
+ * serves before thread_sched's.  A thread's `sched' member names
+ * the class whose run queue holds it, and thread.c routes the run
+ * queue hooks and TICK through it.  The remaining hooks always go
+ * to thread_sched, which keeps tracking priority and nice for
+ * EDF threads in case they leave that class.
+ *
+ * All hooks are mandatory and run with interrupts off unless
+ * noted otherwise. */
+struct sched_class {
+	const char *name;
+
+	/* Initializes CPU C's run queue. */
+	void (*init) (struct cpu *c);
+
+	/* Called once from thread_start(), with interrupts on, to
+	   start any helper threads the policy needs. */
+	void (*start) (void);
+
+	/* Run queue operations, called with C->rq_lock held.
+	   ENQUEUE adds ready thread T to C's run queue, and PICK_NEXT
+	   removes and returns the thread C should run next, or NULL if
+	   the queue is empty.
+	   C->nr_ready already counts T when ENQUEUE is called; a class
+	   that parks T off its queue must take it back out. */
+	void (*enqueue) (struct cpu *c, struct thread *t);
+	struct thread *(*pick_next) (struct cpu *c);
+
+	/* Called from the timer interrupt for each tick that thread T
+	   runs on C, including C's idle thread.  Returns true if T
+	   should be preempted when the interrupt returns. */
+	bool (*tick) (struct cpu *c, struct thread *t);
+
+	/* Returns true if running thread T should give up C because a
+	   thread on C's run queue deserves it more. */
+	bool (*yield_check) (struct cpu *c, struct thread *t);
+
+	/* T's effective priority changed while it waits on C's run
+	   queue.  Called with C->rq_lock held. */
+	void (*priority_changed) (struct cpu *c, struct thread *t);
+
+	/* Implement thread_set_priority() and thread_set_nice() for the
+	   running thread.  Called with interrupts on. */
+	void (*set_priority) (int priority);
+	void (*set_nice) (int nice);
+
+	/* Called when thread T, with T->wait_on_lock set to LOCK, is
+	   about to block on LOCK or already blocks on it, while another
+	   thread holds it, and when the running thread is about to
+	   release LOCK. */
+	void (*lock_wait) (struct thread *t, struct lock *lock);
+	void (*lock_release) (struct lock *lock);
+};
+
+/* Policies, selected by kernel command-line options. */
+extern const struct sched_class sched_priority_class;  /* Default. */
+extern const struct sched_class sched_mlfqs_class;     /* -mlfqs. */
+extern const struct sched_class sched_stride_class;    /* -stride. */
+extern const struct sched_class sched_cfs_class;       /* -cfs. */
+
+/* Deadline class, served ahead of thread_sched. */
+extern const struct sched_class sched_edf_class;
+void edf_print_stats (void);
+
+/* The scheduling class in use.  Set before thread_init() and never
+   changed afterward. */
+extern const struct sched_class *thread_sched;
+
+#endif /* threads/sched.h */
@@ -0,0 +1,24 @@
+#ifndef THREADS_SLAB_H
+#define THREADS_SLAB_H
+
+#include <stddef.h>
+
+/* Slab allocator for fixed-size kernel objects.  See slab.c. */
+
+struct kmem_cache;
+
+/* Prepares a newly created object OBJ.  Run once per object, when
+   its slab is created, not on every allocation: objects must be
+   returned to the cache in their constructed state. */
+typedef void kmem_ctor_func (void *obj);
+
+void kmem_init (void);
+struct kmem_cache *kmem_cache_create (const char *name, size_t size,
+                                      size_t align, kmem_ctor_func *);
+void kmem_cache_destroy (struct kmem_cache *);
+void *kmem_cache_alloc (struct kmem_cache *);
+void kmem_cache_free (struct kmem_cache *, void *);
+size_t kmem_cache_shrink (struct kmem_cache *);
+void kmem_print_stats (void);
+
+#endif /* threads/slab.h */
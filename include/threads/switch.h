@@ -0,0 +1,19 @@
+#ifndef THREADS_SWITCH_H
+#define THREADS_SWITCH_H
+
+#include <stdint.h>
+#include "threads/interrupt.h"
+
+/* Context switches, in switch.S.
+ *
+ * Both functions save the running thread's callee-saved
+ * registers on its stack and store its stack pointer in
+ * *SAVED_RSP.  The thread resumes, returning from the call, when
+ * another thread passes that stack pointer to switch_context().
+ * switch_to_frame() instead starts a thread from a full
+ * `struct intr_frame' with iretq, for threads that have never
+ * been switched out. */
+void switch_context (uint64_t *saved_rsp, uint64_t next_rsp);
+void switch_to_frame (uint64_t *saved_rsp, struct intr_frame *tf);
+
+#endif /* threads/switch.h */
@@ -3,16 +3,19 @@
 
 #include <list.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include "threads/waitq.h"
 
 /* A counting semaphore. */
 struct semaphore {
 	unsigned value;             /* Current value. */
-	struct list waiters;        /* List of waiting threads. */
+	struct waitq waiters;       /* Waiting threads. */
 };
 
 void sema_init (struct semaphore *, unsigned value);
 void sema_down (struct semaphore *);
 bool sema_try_down (struct semaphore *);
+bool sema_down_timeout (struct semaphore *, int64_t timeout);
 void sema_up (struct semaphore *);
 void sema_self_test (void);
 
@@ -20,17 +23,80 @@ void sema_self_test (void);
 struct lock {
 	struct thread *holder;      /* Thread holding lock (for debugging). */
 	struct semaphore semaphore; /* Binary semaphore controlling access. */
+	struct lock_stats *stats;   /* Profile, if named; see lockstat.h. */
 };
 
 void lock_init (struct lock *);
+void lock_init_named (struct lock *, const char *name);
 void lock_acquire (struct lock *);
 bool lock_try_acquire (struct lock *);
 void lock_release (struct lock *);
 bool lock_held_by_current_thread (const struct lock *);
 
+/* Spinlock, for mutual exclusion between CPUs.  Must be held
+   only briefly and only with interrupts off, which excludes other
+   threads on the same CPU. */
+struct spinlock {
+	volatile int locked;        /* Nonzero while held. */
+	struct cpu *cpu;            /* CPU holding the lock (for debugging). */
+	struct lock_stats *stats;   /* Profile, if named; see lockstat.h. */
+};
+
+void spinlock_init (struct spinlock *);
+void spinlock_init_named (struct spinlock *, const char *name);
+void spinlock_acquire (struct spinlock *);
+void spinlock_release (struct spinlock *);
+bool spinlock_held_by_current_cpu (const struct spinlock *);
+
+/* Readers-writer lock.  Any number of readers may hold it at
+   once, or a single writer.  Writers are preferred: once a
+   writer is waiting, arriving readers wait too.  When a writer
+   releases the lock, every reader waiting at that moment gets in
+   as one batch, ahead of the remaining writers, so neither side
+   starves.  Threads waiting while a writer holds the lock donate
+   their priority to it, as for a lock. */
+struct rwlock {
+	struct lock lock;           /* Holder is the writer, if any. */
+	unsigned readers;           /* Number of readers holding it. */
+	struct list read_waiters;   /* Waiting readers. */
+	struct list write_waiters;  /* Waiting writers. */
+};
+
+void rwlock_init (struct rwlock *);
+void rwlock_init_named (struct rwlock *, const char *name);
+void rwlock_acquire_read (struct rwlock *);
+void rwlock_release_read (struct rwlock *);
+void rwlock_acquire_write (struct rwlock *);
+void rwlock_release_write (struct rwlock *);
+bool rwlock_held_by_current_thread (const struct rwlock *);
+
+/* Sequence lock, for a few words of data that are read often
+   and written rarely.  Readers take no lock and never disable
+   interrupts; they retry if a writer was active meanwhile:
+
+     do
+       {
+         seq = seqlock_read_begin (&sl);
+         ...copy the data...
+       }
+     while (seqlock_read_retry (&sl, seq));
+
+   Writers exclude each other with a spinlock, so they must run
+   with interrupts off. */
+struct seqlock {
+	unsigned sequence;          /* Odd while a write is in progress. */
+	struct spinlock lock;       /* Serializes writers. */
+};
+
+void seqlock_init (struct seqlock *);
+unsigned seqlock_read_begin (const struct seqlock *);
+bool seqlock_read_retry (const struct seqlock *, unsigned seq);
+void seqlock_write_begin (struct seqlock *);
+void seqlock_write_end (struct seqlock *);
+
 /* Condition variable. */
 struct condition {
-	struct list waiters;        /* List of waiting threads. */
+	struct waitq waiters;       /* Waiting threads. */
 };
 
 void cond_init (struct condition *);
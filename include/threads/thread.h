@@ -2,14 +2,21 @@
 #define THREADS_THREAD_H
 
 #include <debug.h>
+#include <heap.h>
 #include <list.h>
+#include <rbtree.h>
+#include <rusage.h>
 #include <stdint.h>
 #include "threads/interrupt.h"
 #include "threads/synch.h"
+#include "devices/timer.h"
 #ifdef VM
 #include "vm/vm.h"
 #endif
 
+struct cpu;
+struct sched_class;
+
 /* States in a thread's life cycle. */
 enum thread_status
 {
@@ -30,10 +37,17 @@ typedef int tid_t;
 #define PRI_MAX 63		 /* Highest priority. */
 
 /* Advenced Scheduler */
+#define NICE_MIN -20
 #define NICE_DEFAULT 0
+#define NICE_MAX 20
 #define RECENT_CPU_DEFAULT 0
 #define LOAD_AVG_DEFAULT 0
 
+/* Stride Scheduler */
+#define TICKETS_MIN 1
+#define TICKETS_DEFAULT 100
+#define TICKETS_MAX 10000
+
 /* Project 2 */
 #define FDT_PAGES 2
 #define FDT_COUNT_LIMIT 128
@@ -102,20 +116,51 @@ struct thread
 	enum thread_status status; /* Thread state. */
 	char name[16];						 /* Name (for debugging purposes). */
 	int priority;							 /* Priority. */
+	int rq_priority;					 /* Run queue level while THREAD_READY. */
+	struct cpu *cpu;					 /* CPU running it or whose run queue holds it. */
+	const struct sched_class *sched; /* Class whose run queue holds it. */
 
 	/* Shared between thread.c and synch.c. */
 	struct list_elem elem; /* List element. */
 
-	int64_t wakeup_tick;
-
 	int init_priority;							// donation이 종료될 때 기존의 priority로 돌아오기 위한 필드
 	struct lock *wait_on_lock;			// 스레드가 요청했지만 다른 스레드가 점유하고 있어서 획득하지 못하고 기다리는 lock
 	struct list donations;					// lock을 요청하면서 priority를 기부한 스레드들
 	struct list_elem donation_elem; // donations에 들어가기위한 elem
+	struct waitq *waitq;						// 기다리고 있는 세마포어/조건 변수의 대기 큐, 없으면 NULL
+	struct heap_elem wait_elem;			// waitq 요소
+	uint64_t wait_seq;							// waitq에 들어온 순서, 같은 우선순위끼리는 먼저 온 스레드부터
 
 	// advanced scheduler(mlfqs)
 	int nice;
 	int recent_cpu;
+	bool mlfqs_dirty;						// recent_cpu가 바뀌어 priority 재계산이 필요한지
+	struct list_elem mlfqs_elem; // thread.c의 mlfqs_dirty_list 요소
+
+	// stride scheduler
+	int tickets;									// CPU 몫, 자식 스레드에 상속된다
+	int64_t pass;									// 가상 시간, 가장 작은 스레드가 다음에 실행된다
+	struct heap_elem heap_elem;		// 스케줄러 클래스의 heap 요소
+
+	// CFS scheduler
+	int64_t vruntime;							// nice 가중치로 환산한 누적 실행 시간
+	struct rb_elem rb_elem;				// cfs_rq 요소
+
+	// EDF scheduler (thread_set_deadline()로 등록, 단위는 ticks)
+	int64_t dl_runtime;						// 주기마다 보장받는 실행 시간
+	int64_t dl_period;						// 주기
+	int64_t dl_deadline;					// 주기 시작부터 마감까지의 상대 시간
+	int64_t dl_abs_deadline;			// 현재 작업의 절대 마감 시각
+	int64_t dl_budget;						// 현재 주기에 남은 실행 시간
+	bool dl_throttled;						// budget을 다 써서 다음 주기를 기다리는 중
+	bool dl_missed;								// 현재 작업이 마감을 놓쳤는지
+	struct timer_event dl_timer;	// 다음 주기에 budget을 채워주는 타이머
+
+	// 자원 사용량 (getrusage)
+	struct rusage rusage;				// 이 스레드가 사용한 자원
+	struct rusage child_rusage; // wait으로 회수한 자식들의 합계 (메인 스레드)
+	struct rusage exited_rusage; // 끝난 유저 스레드들의 합계 (메인 스레드)
+	int64_t ready_since;				// run queue에 들어간 시각 (ticks)
 	struct list_elem all_elem;
 	struct list all_list; // 생성되는 모든 리스트
 
@@ -129,13 +174,15 @@ struct thread
 #endif
 
 	/* Owned by thread.c. */
-	struct intr_frame tf; /* Information for switching */
+	struct intr_frame tf; /* Initial context of a new thread. */
+	uint64_t ctx_rsp;			/* Stack pointer saved by the last switch, or 0. */
 	unsigned magic;				/* Detects stack overflow. */
 
 	/* Project2 : User programs - system call - */
 	int exit_status;										 // exit(), wait() 구현 때 사용
 	struct file **file_descriptor_table; // FDT
 	int fdidx;													 // fd index
+	struct lock fdt_lock;								 // FDT와 그 안의 파일 객체를 보호 (메인 스레드)
 
 	struct intr_frame parent_if; // 부모 프로세스의 유저 스택 정보를 담아야 한다.
 	struct list child_list;			 // 자식 프로세스 리스트
@@ -146,6 +193,16 @@ struct thread
 	struct semaphore wait_sema;
 
 	struct file *running; // rox
+
+	// 유저 스레드 (같은 프로세스의 스레드들은 pml4, SPT, FDT를 공유한다)
+	struct thread *leader;				 // 프로세스의 메인 스레드, 메인 스레드와 커널 스레드는 자기 자신
+	struct list threads;					 // 메인 스레드가 가진 유저 스레드 중 join되지 않은 것들
+	struct list_elem thread_elem;	 // threads 리스트 요소
+	bool joined;									 // 다른 스레드가 join했는지
+	int live_threads;							 // 아직 끝나지 않은 유저 스레드 수 (메인 스레드)
+	struct semaphore threads_sema; // 유저 스레드가 끝날 때마다 up (메인 스레드)
+	bool exiting;									 // 프로세스가 종료 중인지 (메인 스레드)
+	uint64_t fs_base;							 // TLS 포인터, 스레드 전환 때 FS base에 넣는다
 };
 
 /* If false (default), use round-robin scheduler.
@@ -156,7 +213,7 @@ extern bool thread_mlfqs;
 void thread_init(void);
 void thread_start(void);
 
-void thread_tick(void);
+void thread_tick(bool user);
 void thread_print_stats(void);
 
 typedef void thread_func(void *aux);
@@ -180,6 +237,12 @@ void thread_set_nice(int);
 int thread_get_recent_cpu(void);
 int thread_get_load_avg(void);
 
+int thread_get_tickets(void);
+bool thread_set_tickets(int);
+
+bool thread_set_deadline(int64_t runtime, int64_t period, int64_t deadline);
+void thread_wait_period(void);
+
 void do_iret(struct intr_frame *tf);
 
 void thread_sleep(int64_t ticks);
@@ -187,9 +250,10 @@ void thread_sleep(int64_t ticks);
 // 우선순위 비교
 bool cmp_priority(const struct list_elem *a, const struct list_elem *b, void *aux UNUSED);
 void preempt_priority(void); // ready에 있는 스레드가 현재 실행되는 스레드 보다 우선순위가 높으면 교체
+void thread_update_priority(struct thread *t, int priority);
 
 bool cmp_d_priority(const struct list_elem *a, const struct list_elem *b, void *aux);
-void donate_priority(void);
+void donate_priority(struct thread *t);
 void remove_donor(struct lock *lock);
 void update_priority_before_donations(void);
 
@@ -0,0 +1,40 @@
+#ifndef THREADS_TRACE_H
+#define THREADS_TRACE_H
+
+#include <stdint.h>
+
+/* Scheduler event tracing.
+ *
+ * Each CPU records scheduler events into its own fixed-size ring,
+ * overwriting the oldest events once it is full.  A CPU only ever
+ * writes its own ring, with interrupts off, so recording takes no
+ * lock: it costs an rdtsc and a few stores, cheap enough to leave
+ * on all the time.
+ *
+ * trace_dump() prints the rings, oldest event first, for
+ * utils/pintos-trace to turn into per-thread timelines and wakeup
+ * latency histograms.  The kernel dumps them on power-off when
+ * given -trace, or at any point with the `trace' action. */
+
+/* Kinds of events.  Arguments are listed in order. */
+enum trace_type {
+	TRACE_CREATE,       /* Thread created: tid, name. */
+	TRACE_SWITCH,       /* Context switch: prev tid, next tid, prev status. */
+	TRACE_WAKEUP,       /* Thread made ready: tid, waker tid, CPU. */
+	TRACE_BLOCK,        /* Thread blocked: tid. */
+	TRACE_DONATE,       /* Priority donated: holder tid, priority, donor. */
+	TRACE_PREEMPT,      /* Preemption requested: tid, reason. */
+};
+
+/* Reasons for TRACE_PREEMPT. */
+enum trace_preempt_reason {
+	TRACE_PREEMPT_SLICE,    /* Time slice ran out. */
+	TRACE_PREEMPT_READY,    /* A ready thread should run first. */
+};
+
+void trace_init (void);
+void trace_record (enum trace_type, int tid, int arg, int arg2);
+void trace_record_create (int tid, const char *name);
+void trace_dump (void);
+
+#endif /* threads/trace.h */
@@ -0,0 +1,27 @@
+#ifndef THREADS_VMALLOC_H
+#define THREADS_VMALLOC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Kernel virtual range for vmalloc().  It lies in the same
+   page-map-level-4 slot as the kernel's mapping of physical
+   memory, so the page tables below it are shared by every
+   pml4_create()d page map.  Addresses in it are not in the
+   physical memory map: vtop() does not work on them. */
+#define VMALLOC_START 0xc000000000
+#define VMALLOC_END   (VMALLOC_START + 0x10000000)  /* 256 MB. */
+
+/* Returns true if VADDR is in the vmalloc() range. */
+#define is_vmalloc_addr(vaddr) \
+	((uint64_t) (vaddr) >= VMALLOC_START && (uint64_t) (vaddr) < VMALLOC_END)
+
+void vmalloc_init (void);
+void *vmalloc (size_t size);
+void vfree (void *);
+
+void *kvmalloc (size_t size);
+void kvfree (void *, size_t size);
+
+#endif /* threads/vmalloc.h */
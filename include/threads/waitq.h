@@ -0,0 +1,33 @@
+#ifndef THREADS_WAITQ_H
+#define THREADS_WAITQ_H
+
+#include <heap.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+struct thread;
+
+/* Priority wait queue.
+
+   Holds blocked threads in order of priority, and in order of
+   arrival among threads of equal priority.  Each thread is on
+   at most one wait queue at a time, through its wait_elem member,
+   and t->waitq points to that queue.  When a waiting thread's
+   priority changes, as it does through priority donation,
+   thread_update_priority() calls waitq_requeue() to move it to its
+   new place.
+
+   Wait queues are protected by disabling interrupts. */
+struct waitq {
+	struct heap heap;           /* Waiting threads, next first. */
+	uint64_t next_seq;          /* Arrival stamp for the next thread. */
+};
+
+void waitq_init (struct waitq *);
+bool waitq_empty (const struct waitq *);
+void waitq_push (struct waitq *, struct thread *);
+struct thread *waitq_pop (struct waitq *);
+void waitq_remove (struct thread *);
+void waitq_requeue (struct thread *);
+
+#endif /* threads/waitq.h */
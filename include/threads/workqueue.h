@@ -0,0 +1,59 @@
+#ifndef THREADS_WORKQUEUE_H
+#define THREADS_WORKQUEUE_H
+
+#include <list.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "devices/timer.h"
+
+/* Work queues.
+ *
+ * A work queue runs deferred work items in a small, fixed pool of
+ * kernel worker threads.  Work may be queued from any context,
+ * including interrupt handlers, which lets a handler hand off
+ * anything that needs to sleep or take a while, and lets
+ * subsystems share a few threads instead of each starting its
+ * own daemon.
+ *
+ * The caller owns each `struct work' and must keep it alive until
+ * it has run.  A work item is pending from the time it is queued
+ * until a worker picks it up; queuing a pending item again does
+ * nothing, so a burst of requests collapses into a single run.
+ * The item may be queued again, even by its own function, as soon
+ * as the function has started.  Items are started in the order
+ * they were queued, but with more than one worker they may run
+ * concurrently. */
+
+struct work;
+typedef void work_func (struct work *);
+
+/* A work item.  Embed it in a larger structure and use
+   list_entry()-style pointer arithmetic to get back to it. */
+struct work {
+	struct list_elem elem;          /* Element in workqueue's list. */
+	work_func *func;                /* Function to run. */
+	bool pending;                   /* Queued but not yet started? */
+	struct workqueue *wq;           /* Queue it was last queued on. */
+};
+
+/* A work item queued after a delay. */
+struct delayed_work {
+	struct work work;               /* The work item itself. */
+	struct timer_event timer;       /* Queues WORK when it expires. */
+};
+
+void work_init (struct work *, work_func *);
+void delayed_work_init (struct delayed_work *, work_func *);
+
+struct workqueue *workqueue_create (const char *name, int max_workers);
+bool queue_work (struct workqueue *, struct work *);
+bool queue_delayed_work (struct workqueue *, struct delayed_work *,
+                         int64_t delay);
+bool cancel_delayed_work (struct delayed_work *);
+void flush_workqueue (struct workqueue *);
+
+/* Shared work queue for work that needs no queue of its own. */
+extern struct workqueue *system_wq;
+void workqueue_init (void);
+
+#endif /* threads/workqueue.h */
@@ -0,0 +1,13 @@
+#ifndef USERPROG_FUTEX_H
+#define USERPROG_FUTEX_H
+
+#include <stdint.h>
+
+struct thread;
+
+void futex_init (void);
+int futex_wait (int *uaddr, int expected, int64_t timeout);
+int futex_wake (int *uaddr, int count);
+void futex_wake_process (struct thread *leader);
+
+#endif /* userprog/futex.h */
@@ -10,8 +10,18 @@ int process_wait(tid_t);
 void process_exit(void);
 void process_activate(struct thread *next);
 
+tid_t process_thread_create(struct intr_frame *f, uint64_t entry, uint64_t arg0,
+														uint64_t arg1, uint64_t stack, uint64_t tls);
+int process_thread_join(tid_t tid);
+void process_set_tls(uint64_t tls);
+void process_terminate(int status);
+void process_check_exiting(void);
+void process_get_rusage(struct thread *leader, struct rusage *usage);
+
 void argument_stack(char **parse, int count, void **rsp);
 
+void process_lock_files(void);
+void process_unlock_files(void);
 int process_add_file(struct file *file);
 struct file *process_get_file(int fd);
 void process_close_file(int fd);
@@ -3,7 +3,7 @@
 #include "threads/synch.h"
 
 void syscall_init(void);
-struct lock filesys_lock;
+extern struct rwlock filesys_lock;
 // void check_address(void *);
 // void halt(void);
 // void exit(int);
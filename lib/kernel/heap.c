@@ -0,0 +1,176 @@
+#include "heap.h"
+#include "../debug.h"
+
+/* Pairing heap.
+
+   Each element points to its leftmost child and to its right
+   sibling.  Its `prev' member points to its left sibling or, for
+   a leftmost child, to its parent, so that any element can be
+   unlinked from the tree in constant time.  The root has no
+   siblings and a null `prev'.
+
+   The heap order is the only invariant: no element is less than
+   its parent.  All the real work happens in combine_siblings(),
+   which restores a single tree after the root, or the root of a
+   subtree, has been removed. */
+
+static struct heap_elem *meld (struct heap *,
+                               struct heap_elem *, struct heap_elem *);
+static struct heap_elem *combine_siblings (struct heap *,
+                                           struct heap_elem *);
+
+/* Initializes HEAP as an empty heap ordered by LESS, given
+   auxiliary data AUX. */
+void
+heap_init (struct heap *heap, heap_less_func *less, void *aux) {
+	ASSERT (heap != NULL);
+	ASSERT (less != NULL);
+
+	heap->root = NULL;
+	heap->size = 0;
+	heap->less = less;
+	heap->aux = aux;
+}
+
+/* Returns true if HEAP is empty, false otherwise. */
+bool
+heap_empty (const struct heap *heap) {
+	return heap->root == NULL;
+}
+
+/* Returns the number of elements in HEAP. */
+size_t
+heap_size (const struct heap *heap) {
+	return heap->size;
+}
+
+/* Inserts ELEM into HEAP. */
+void
+heap_insert (struct heap *heap, struct heap_elem *elem) {
+	ASSERT (heap != NULL);
+	ASSERT (elem != NULL);
+
+	elem->child = elem->next = elem->prev = NULL;
+	heap->root = meld (heap, heap->root, elem);
+	heap->size++;
+}
+
+/* Returns the minimum element in HEAP, or a null pointer if HEAP
+   is empty.  When several elements compare equal, any one of
+   them may be returned. */
+struct heap_elem *
+heap_min (const struct heap *heap) {
+	return heap->root;
+}
+
+/* Removes and returns the minimum element in HEAP, which must
+   not be empty. */
+struct heap_elem *
+heap_pop_min (struct heap *heap) {
+	struct heap_elem *min = heap->root;
+
+	ASSERT (!heap_empty (heap));
+
+	heap->root = combine_siblings (heap, min->child);
+	heap->size--;
+	min->child = NULL;
+	return min;
+}
+
+/* Removes ELEM, which must be in HEAP, from HEAP. */
+void
+heap_remove (struct heap *heap, struct heap_elem *elem) {
+	struct heap_elem *subtree;
+
+	ASSERT (!heap_empty (heap));
+	ASSERT (elem != NULL);
+
+	if (elem == heap->root) {
+		heap_pop_min (heap);
+		return;
+	}
+
+	/* Unlink ELEM, with its subtree, from its parent or left
+	   sibling. */
+	if (elem->prev->child == elem)
+		elem->prev->child = elem->next;
+	else
+		elem->prev->next = elem->next;
+	if (elem->next != NULL)
+		elem->next->prev = elem->prev;
+
+	/* Merge the subtree, without ELEM, back in. */
+	subtree = combine_siblings (heap, elem->child);
+	heap->root = meld (heap, heap->root, subtree);
+	heap->size--;
+	elem->child = elem->next = elem->prev = NULL;
+}
+
+/* Merges the trees rooted at A and B, either of which may be
+   null, and returns the root of the result.  A and B must have
+   no siblings.  The root that compares greater becomes the
+   leftmost child of the other. */
+static struct heap_elem *
+meld (struct heap *heap, struct heap_elem *a, struct heap_elem *b) {
+	struct heap_elem *t;
+
+	if (a == NULL)
+		return b;
+	if (b == NULL)
+		return a;
+
+	if (heap->less (b, a, heap->aux)) {
+		t = a;
+		a = b;
+		b = t;
+	}
+
+	b->prev = a;
+	b->next = a->child;
+	if (a->child != NULL)
+		a->child->prev = b;
+	a->child = b;
+	return a;
+}
+
+/* Merges the list of sibling trees that starts at FIRST, which
+   may be null, into a single tree and returns its root.
+
+   This is the standard two-pass scheme: melding the siblings in
+   pairs from left to right, then melding the pairs together from
+   right to left, is what gives the pairing heap its logarithmic
+   amortized bound. */
+static struct heap_elem *
+combine_siblings (struct heap *heap, struct heap_elem *first) {
+	struct heap_elem *pairs = NULL;
+	struct heap_elem *root = NULL;
+
+	/* First pass: meld adjacent pairs, stacking the results on
+	   PAIRS through their `next' members. */
+	while (first != NULL) {
+		struct heap_elem *a = first;
+		struct heap_elem *b = a->next;
+
+		first = b != NULL ? b->next : NULL;
+		a->next = a->prev = NULL;
+		if (b != NULL)
+			b->next = b->prev = NULL;
+
+		a = meld (heap, a, b);
+		a->next = pairs;
+		pairs = a;
+	}
+
+	/* Second pass: meld the stacked pairs, last pair first. */
+	while (pairs != NULL) {
+		struct heap_elem *next = pairs->next;
+
+		pairs->next = NULL;
+		root = meld (heap, root, pairs);
+		pairs = next;
+	}
+
+	if (root != NULL)
+		root->prev = NULL;
+	return root;
+}
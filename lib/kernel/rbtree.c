@@ -0,0 +1,306 @@
+#include "rbtree.h"
+#include "../debug.h"
+
+/* Red-black tree.
+
+   Null children are the black leaves of the textbook algorithm.
+   The tree maintains the usual invariants: the root is black, a
+   red element has no red child, and every path from an element
+   down to a leaf passes through the same number of black
+   elements.  Together these keep the height below 2 lg (n + 1). */
+
+static void rotate_left (struct rbtree *, struct rb_elem *);
+static void rotate_right (struct rbtree *, struct rb_elem *);
+static void replace_child (struct rbtree *, struct rb_elem *old,
+                           struct rb_elem *new);
+static void remove_fixup (struct rbtree *, struct rb_elem *,
+                          struct rb_elem *parent);
+
+/* Returns true if E is a red element.  Leaves are black. */
+static inline bool
+is_red (const struct rb_elem *e) {
+	return e != NULL && e->red;
+}
+
+/* Initializes TREE as an empty tree ordered by LESS, given
+   auxiliary data AUX. */
+void
+rbtree_init (struct rbtree *tree, rb_less_func *less, void *aux) {
+	ASSERT (tree != NULL);
+	ASSERT (less != NULL);
+
+	tree->root = tree->first = NULL;
+	tree->size = 0;
+	tree->less = less;
+	tree->aux = aux;
+}
+
+/* Returns true if TREE is empty, false otherwise. */
+bool
+rbtree_empty (const struct rbtree *tree) {
+	return tree->root == NULL;
+}
+
+/* Returns the number of elements in TREE. */
+size_t
+rbtree_size (const struct rbtree *tree) {
+	return tree->size;
+}
+
+/* Inserts ELEM into TREE, after any elements that compare equal
+   to it. */
+void
+rbtree_insert (struct rbtree *tree, struct rb_elem *elem) {
+	struct rb_elem **link = &tree->root;
+	struct rb_elem *parent = NULL;
+	bool leftmost = true;
+
+	ASSERT (elem != NULL);
+
+	/* Find ELEM's place, as in an ordinary binary search tree. */
+	while (*link != NULL) {
+		parent = *link;
+		if (tree->less (elem, parent, tree->aux))
+			link = &parent->left;
+		else {
+			link = &parent->right;
+			leftmost = false;
+		}
+	}
+	elem->parent = parent;
+	elem->left = elem->right = NULL;
+	elem->red = true;
+	*link = elem;
+	if (leftmost)
+		tree->first = elem;
+	tree->size++;
+
+	/* Restore the invariants: while ELEM and its parent are both
+	   red, recolor or rotate. */
+	while (is_red (parent = elem->parent)) {
+		struct rb_elem *grandparent = parent->parent;
+
+		if (parent == grandparent->left) {
+			struct rb_elem *uncle = grandparent->right;
+
+			if (is_red (uncle)) {
+				parent->red = uncle->red = false;
+				grandparent->red = true;
+				elem = grandparent;
+				continue;
+			}
+			if (elem == parent->right) {
+				rotate_left (tree, parent);
+				elem = parent;
+				parent = elem->parent;
+			}
+			parent->red = false;
+			grandparent->red = true;
+			rotate_right (tree, grandparent);
+		} else {
+			struct rb_elem *uncle = grandparent->left;
+
+			if (is_red (uncle)) {
+				parent->red = uncle->red = false;
+				grandparent->red = true;
+				elem = grandparent;
+				continue;
+			}
+			if (elem == parent->left) {
+				rotate_right (tree, parent);
+				elem = parent;
+				parent = elem->parent;
+			}
+			parent->red = false;
+			grandparent->red = true;
+			rotate_left (tree, grandparent);
+		}
+	}
+	tree->root->red = false;
+}
+
+/* Removes ELEM, which must be in TREE, from TREE. */
+void
+rbtree_remove (struct rbtree *tree, struct rb_elem *elem) {
+	struct rb_elem *child, *parent;
+	bool removed_red;
+
+	ASSERT (!rbtree_empty (tree));
+	ASSERT (elem != NULL);
+
+	if (elem == tree->first)
+		tree->first = rbtree_next (elem);
+	tree->size--;
+
+	if (elem->left == NULL || elem->right == NULL) {
+		/* ELEM has at most one child, which takes its place. */
+		child = elem->left != NULL ? elem->left : elem->right;
+		parent = elem->parent;
+		removed_red = elem->red;
+		replace_child (tree, elem, child);
+		if (child != NULL)
+			child->parent = parent;
+	} else {
+		/* ELEM's successor, which has no left child, takes its
+		   place and color.  The successor's old position is the
+		   one that loses an element. */
+		struct rb_elem *next = elem->right;
+
+		while (next->left != NULL)
+			next = next->left;
+		child = next->right;
+		removed_red = next->red;
+
+		if (next->parent == elem)
+			parent = next;
+		else {
+			parent = next->parent;
+			parent->left = child;
+			if (child != NULL)
+				child->parent = parent;
+			next->right = elem->right;
+			next->right->parent = next;
+		}
+		next->left = elem->left;
+		next->left->parent = next;
+		next->red = elem->red;
+		replace_child (tree, elem, next);
+		next->parent = elem->parent;
+	}
+
+	if (!removed_red)
+		remove_fixup (tree, child, parent);
+	elem->parent = elem->left = elem->right = NULL;
+}
+
+/* Returns the least element in TREE, or a null pointer if TREE is
+   empty. */
+struct rb_elem *
+rbtree_first (const struct rbtree *tree) {
+	return tree->first;
+}
+
+/* Returns the element that follows ELEM in its tree, or a null
+   pointer if ELEM is the greatest element. */
+struct rb_elem *
+rbtree_next (const struct rb_elem *elem) {
+	ASSERT (elem != NULL);
+
+	if (elem->right != NULL) {
+		elem = elem->right;
+		while (elem->left != NULL)
+			elem = elem->left;
+		return (struct rb_elem *) elem;
+	}
+	while (elem->parent != NULL && elem == elem->parent->right)
+		elem = elem->parent;
+	return elem->parent;
+}
+
+/* Makes NEW, which may be null, take OLD's place as the child of
+   OLD's parent, or as the root of TREE.  Does not update NEW's
+   parent pointer. */
+static void
+replace_child (struct rbtree *tree, struct rb_elem *old,
+               struct rb_elem *new) {
+	if (old->parent == NULL)
+		tree->root = new;
+	else if (old == old->parent->left)
+		old->parent->left = new;
+	else
+		old->parent->right = new;
+}
+
+/* Rotates the subtree rooted at E to the left, so that E's right
+   child takes its place and E becomes that child's left child. */
+static void
+rotate_left (struct rbtree *tree, struct rb_elem *e) {
+	struct rb_elem *r = e->right;
+
+	e->right = r->left;
+	if (r->left != NULL)
+		r->left->parent = e;
+	replace_child (tree, e, r);
+	r->parent = e->parent;
+	r->left = e;
+	e->parent = r;
+}
+
+/* Rotates the subtree rooted at E to the right, so that E's left
+   child takes its place and E becomes that child's right child. */
+static void
+rotate_right (struct rbtree *tree, struct rb_elem *e) {
+	struct rb_elem *l = e->left;
+
+	e->left = l->right;
+	if (l->right != NULL)
+		l->right->parent = e;
+	replace_child (tree, e, l);
+	l->parent = e->parent;
+	l->right = e;
+	e->parent = l;
+}
+
+/* Restores the invariants after a black element was removed from
+   between PARENT and its child E, which may be a leaf, leaving
+   paths through E one black element short. */
+static void
+remove_fixup (struct rbtree *tree, struct rb_elem *e,
+              struct rb_elem *parent) {
+	while (e != tree->root && !is_red (e)) {
+		if (e == parent->left) {
+			struct rb_elem *sibling = parent->right;
+
+			if (is_red (sibling)) {
+				sibling->red = false;
+				parent->red = true;
+				rotate_left (tree, parent);
+				sibling = parent->right;
+			}
+			if (!is_red (sibling->left) && !is_red (sibling->right)) {
+				sibling->red = true;
+				e = parent;
+				parent = e->parent;
+				continue;
+			}
+			if (!is_red (sibling->right)) {
+				sibling->left->red = false;
+				sibling->red = true;
+				rotate_right (tree, sibling);
+				sibling = parent->right;
+			}
+			sibling->red = parent->red;
+			parent->red = false;
+			sibling->right->red = false;
+			rotate_left (tree, parent);
+		} else {
+			struct rb_elem *sibling = parent->left;
+
+			if (is_red (sibling)) {
+				sibling->red = false;
+				parent->red = true;
+				rotate_right (tree, parent);
+				sibling = parent->left;
+			}
+			if (!is_red (sibling->left) && !is_red (sibling->right)) {
+				sibling->red = true;
+				e = parent;
+				parent = e->parent;
+				continue;
+			}
+			if (!is_red (sibling->left)) {
+				sibling->right->red = false;
+				sibling->red = true;
+				rotate_left (tree, sibling);
+				sibling = parent->left;
+			}
+			sibling->red = parent->red;
+			parent->red = false;
+			sibling->left->red = false;
+			rotate_right (tree, parent);
+		}
+		e = tree->root;
+	}
+	if (e != NULL)
+		e->red = false;
+}
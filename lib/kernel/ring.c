@@ -0,0 +1,148 @@
+#include "ring.h"
+#include <string.h>
+#include "../debug.h"
+
+/* Single-producer, single-consumer ring buffer.
+
+   HEAD and TAIL count elements added and removed since
+   ring_init() and are never reduced modulo the capacity, so
+   HEAD - TAIL is the number of elements in the ring even after
+   they wrap around, and a full ring is told apart from an empty
+   one without wasting a slot.  Element I lives in slot
+   I & MASK. */
+
+/* Loads the other side's index.  Pairs with publish(). */
+static inline size_t
+observe (const size_t *index) {
+	return __atomic_load_n (index, __ATOMIC_ACQUIRE);
+}
+
+/* Stores our own index after the elements it covers. */
+static inline void
+publish (size_t *index, size_t value) {
+	__atomic_store_n (index, value, __ATOMIC_RELEASE);
+}
+
+/* Initializes RING as an empty ring of CNT elements of ELEM_SIZE
+   bytes each, stored in BUF.  CNT must be a power of 2. */
+void
+ring_init (struct ring *ring, void *buf, size_t cnt, size_t elem_size) {
+	ASSERT (ring != NULL);
+	ASSERT (buf != NULL);
+	ASSERT (cnt > 0 && (cnt & (cnt - 1)) == 0);
+	ASSERT (elem_size > 0);
+
+	ring->buf = buf;
+	ring->elem_size = elem_size;
+	ring->mask = cnt - 1;
+	ring->head = ring->tail = 0;
+}
+
+/* Returns the number of elements RING can hold. */
+size_t
+ring_capacity (const struct ring *ring) {
+	return ring->mask + 1;
+}
+
+/* Returns the number of elements in RING.  Exact when called by
+   the producer or the consumer, a snapshot otherwise.
+
+   TAIL is loaded first: HEAD never falls behind a TAIL read
+   earlier, so the difference cannot underflow.  A third thread
+   can still see HEAD run a full lap ahead of the TAIL it read,
+   so the result is capped at the capacity. */
+size_t
+ring_count (const struct ring *ring) {
+	size_t tail = observe (&ring->tail);
+	size_t count = observe (&ring->head) - tail;
+
+	return count < ring_capacity (ring) ? count : ring_capacity (ring);
+}
+
+/* Returns the number of elements that can be added to RING. */
+size_t
+ring_space (const struct ring *ring) {
+	return ring_capacity (ring) - ring_count (ring);
+}
+
+/* Returns true if RING has no elements. */
+bool
+ring_empty (const struct ring *ring) {
+	return ring_count (ring) == 0;
+}
+
+/* Returns true if RING has no room for another element. */
+bool
+ring_full (const struct ring *ring) {
+	return ring_count (ring) == ring_capacity (ring);
+}
+
+/* Copies CNT elements between the ring slots starting at element
+   I and DATA, in the direction given by TO_RING, wrapping around
+   the end of the array. */
+static void
+copy (struct ring *ring, size_t i, void *data, size_t cnt, bool to_ring) {
+	size_t slot = i & ring->mask;
+	size_t first = ring_capacity (ring) - slot;
+	uint8_t *p = data;
+
+	if (first > cnt)
+		first = cnt;
+	if (to_ring) {
+		memcpy (ring->buf + slot * ring->elem_size, p, first * ring->elem_size);
+		memcpy (ring->buf, p + first * ring->elem_size,
+		        (cnt - first) * ring->elem_size);
+	} else {
+		memcpy (p, ring->buf + slot * ring->elem_size, first * ring->elem_size);
+		memcpy (p + first * ring->elem_size, ring->buf,
+		        (cnt - first) * ring->elem_size);
+	}
+}
+
+/* Adds up to CNT elements from ELEMS to the end of RING, as many
+   as there is room for, and returns how many were added.  Only
+   the producer may call this. */
+size_t
+ring_push_many (struct ring *ring, const void *elems, size_t cnt) {
+	size_t head = ring->head;
+	size_t space = ring_capacity (ring) - (head - observe (&ring->tail));
+
+	if (cnt > space)
+		cnt = space;
+	if (cnt > 0) {
+		copy (ring, head, (void *) elems, cnt, true);
+		publish (&ring->head, head + cnt);
+	}
+	return cnt;
+}
+
+/* Removes up to CNT elements from the front of RING into ELEMS,
+   as many as there are, and returns how many were removed.  Only
+   the consumer may call this. */
+size_t
+ring_pop_many (struct ring *ring, void *elems, size_t cnt) {
+	size_t tail = ring->tail;
+	size_t avail = observe (&ring->head) - tail;
+
+	if (cnt > avail)
+		cnt = avail;
+	if (cnt > 0) {
+		copy (ring, tail, elems, cnt, false);
+		publish (&ring->tail, tail + cnt);
+	}
+	return cnt;
+}
+
+/* Adds ELEM to the end of RING.  Returns false, without adding
+   it, if RING is full. */
+bool
+ring_push (struct ring *ring, const void *elem) {
+	return ring_push_many (ring, elem, 1) == 1;
+}
+
+/* Removes the element at the front of RING into ELEM.  Returns
+   false if RING is empty. */
+bool
+ring_pop (struct ring *ring, void *elem) {
+	return ring_pop_many (ring, elem, 1) == 1;
+}
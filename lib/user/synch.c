@@ -0,0 +1,107 @@
+#include <synch.h>
+#include <limits.h>
+#include <syscall.h>
+
+/* A mutex's state is 0 when it is free, 1 when it is locked with
+   no waiters, and 2 when it is locked and threads may be sleeping
+   on it in futex_wait().  The holder only has to call
+   futex_wake() when unlocking a mutex in state 2.  See Ulrich
+   Drepper, "Futexes Are Tricky". */
+
+/* Compares *P with EXPECTED and, if equal, stores DESIRED.
+   Returns the value *P held. */
+static int
+cmpxchg (int *p, int expected, int desired) {
+	__atomic_compare_exchange_n (p, &expected, desired, false,
+	                             __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+	return expected;
+}
+
+/* Initializes MUTEX as free. */
+void
+mutex_init (struct mutex *mutex) {
+	mutex->state = 0;
+}
+
+/* Acquires MUTEX, sleeping until it is free if need be. */
+void
+mutex_lock (struct mutex *mutex) {
+	int c = cmpxchg (&mutex->state, 0, 1);
+
+	if (c == 0)
+		return;
+
+	/* Mark the mutex contended, then sleep until the holder
+	   releases it.  Whoever takes it from here on leaves it
+	   contended, since other threads may still be sleeping. */
+	if (c != 2)
+		c = __atomic_exchange_n (&mutex->state, 2, __ATOMIC_ACQUIRE);
+	while (c != 0) {
+		futex_wait (&mutex->state, 2, -1);
+		c = __atomic_exchange_n (&mutex->state, 2, __ATOMIC_ACQUIRE);
+	}
+}
+
+/* Acquires MUTEX if it is free, without sleeping.  Returns true
+   if successful. */
+bool
+mutex_trylock (struct mutex *mutex) {
+	return cmpxchg (&mutex->state, 0, 1) == 0;
+}
+
+/* Releases MUTEX, which the caller must hold, and wakes up one
+   thread waiting for it, if any. */
+void
+mutex_unlock (struct mutex *mutex) {
+	if (__atomic_fetch_sub (&mutex->state, 1, __ATOMIC_RELEASE) != 1) {
+		__atomic_store_n (&mutex->state, 0, __ATOMIC_RELEASE);
+		futex_wake (&mutex->state, 1);
+	}
+}
+
+/* Initializes COND with no waiters. */
+void
+condvar_init (struct condvar *cond) {
+	cond->seq = 0;
+	cond->waiters = 0;
+}
+
+/* Atomically releases MUTEX and waits for COND to be signaled,
+   then reacquires MUTEX before returning.  MUTEX must be held.
+   As with the kernel's condition variables, a waiter may wake up
+   without the condition being true and must recheck it. */
+void
+condvar_wait (struct condvar *cond, struct mutex *mutex) {
+	int seq;
+
+	/* Both are read under MUTEX, so that a signal sent after we
+	   release it changes SEQ and futex_wait() returns at once
+	   rather than missing the wakeup. */
+	__atomic_fetch_add (&cond->waiters, 1, __ATOMIC_RELAXED);
+	seq = __atomic_load_n (&cond->seq, __ATOMIC_RELAXED);
+	mutex_unlock (mutex);
+
+	futex_wait (&cond->seq, seq, -1);
+
+	mutex_lock (mutex);
+	__atomic_fetch_sub (&cond->waiters, 1, __ATOMIC_RELAXED);
+}
+
+/* Wakes up one thread waiting on COND, if any.  Signaling with no
+   waiters does not enter the kernel. */
+void
+condvar_signal (struct condvar *cond) {
+	if (__atomic_load_n (&cond->waiters, __ATOMIC_RELAXED) > 0) {
+		__atomic_fetch_add (&cond->seq, 1, __ATOMIC_RELEASE);
+		futex_wake (&cond->seq, 1);
+	}
+}
+
+/* Wakes up all threads waiting on COND. */
+void
+condvar_broadcast (struct condvar *cond) {
+	if (__atomic_load_n (&cond->waiters, __ATOMIC_RELAXED) > 0) {
+		__atomic_fetch_add (&cond->seq, 1, __ATOMIC_RELEASE);
+		futex_wake (&cond->seq, INT_MAX);
+	}
+}
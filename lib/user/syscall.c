@@ -194,3 +194,45 @@ int
 umount (const char *path) {
 	return syscall1 (SYS_UMOUNT, path);
 }
+
+int
+set_tickets (int tickets) {
+	return syscall1 (SYS_SET_TICKETS, tickets);
+}
+
+int
+getrusage (int who, struct rusage *usage) {
+	return syscall2 (SYS_GETRUSAGE, who, usage);
+}
+
+int
+futex_wait (int *addr, int expected, int timeout) {
+	return syscall3 (SYS_FUTEX_WAIT, addr, expected, timeout);
+}
+
+int
+futex_wake (int *addr, int count) {
+	return syscall2 (SYS_FUTEX_WAKE, addr, count);
+}
+
+tid_t
+thread_create (void (*entry) (void *, void *), void *arg0, void *arg1,
+               void *stack, void *tls) {
+	return (tid_t) syscall5 (SYS_THREAD_CREATE, entry, arg0, arg1, stack, tls);
+}
+
+int
+thread_join (tid_t tid) {
+	return syscall1 (SYS_THREAD_JOIN, tid);
+}
+
+void
+thread_exit (int status) {
+	syscall1 (SYS_THREAD_EXIT, status);
+	NOT_REACHED ();
+}
+
+void
+set_tls (void *tls) {
+	syscall1 (SYS_SET_TLS, tls);
+}
@@ -0,0 +1,139 @@
+#include <uthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <synch.h>
+
+/* A thread's thread-local storage block.  The FS segment base
+   points to it, and, as the x86-64 ABI requires, its first word
+   points back to it, so that %fs:0 finds it. */
+struct uthread {
+	struct uthread *self;       /* This block. */
+	void *local;                /* uthread_get_local() value. */
+	tid_t tid;                  /* Thread identifier. */
+	bool in_use;                /* Running or not yet joined? */
+	bool joining;               /* Being joined? */
+};
+
+/* The initial thread's block, and those of created threads. */
+static struct uthread initial;
+static struct uthread threads[UTHREAD_MAX];
+static uint8_t stacks[UTHREAD_MAX][UTHREAD_STACK_SIZE]
+	__attribute__ ((aligned (16)));
+
+/* Protects the TID, IN_USE and JOINING members of THREADS. */
+static struct mutex pool_lock = MUTEX_INITIALIZER;
+
+/* Until the first uthread_create(), only the initial thread
+   runs and the FS segment base is not set up. */
+static bool started;
+
+/* Returns the running thread's block. */
+static struct uthread *
+uthread_self (void) {
+	struct uthread *self;
+
+	if (!started)
+		return &initial;
+	asm ("movq %%fs:0, %0" : "=r" (self));
+	return self;
+}
+
+/* First function run by a new thread. */
+static void
+uthread_start (void *func_, void *aux) {
+	uthread_func *func = func_;
+
+	uthread_exit (func (aux));
+}
+
+/* Starts a new thread running FUNC(AUX).  Returns its thread
+   identifier, or TID_ERROR if UTHREAD_MAX threads are already
+   running or unjoined, or if the kernel could not create it. */
+tid_t
+uthread_create (uthread_func *func, void *aux) {
+	struct uthread *t = NULL;
+	tid_t tid;
+	int i;
+
+	if (!started) {
+		initial.self = &initial;
+		set_tls (&initial);
+		started = true;
+	}
+
+	mutex_lock (&pool_lock);
+	for (i = 0; i < UTHREAD_MAX; i++)
+		if (!threads[i].in_use) {
+			t = &threads[i];
+			break;
+		}
+	if (t == NULL) {
+		mutex_unlock (&pool_lock);
+		return TID_ERROR;
+	}
+
+	t->self = t;
+	t->local = NULL;
+	t->joining = false;
+	tid = thread_create (uthread_start, func, aux,
+	                     stacks[i] + UTHREAD_STACK_SIZE, t);
+	t->tid = tid;
+	t->in_use = tid != TID_ERROR;
+	mutex_unlock (&pool_lock);
+
+	return tid;
+}
+
+/* Waits for thread TID, started by uthread_create(), to finish
+   and returns its exit status, the value its function returned
+   or passed to uthread_exit().  Returns -1 if TID is not a
+   running or unjoined thread, if it is the running thread, or if
+   another thread is already joining it. */
+int
+uthread_join (tid_t tid) {
+	struct uthread *t = NULL;
+	int status;
+	int i;
+
+	mutex_lock (&pool_lock);
+	for (i = 0; i < UTHREAD_MAX; i++)
+		if (threads[i].in_use && threads[i].tid == tid) {
+			t = &threads[i];
+			break;
+		}
+	if (t == NULL || t->joining || t == uthread_self ()) {
+		mutex_unlock (&pool_lock);
+		return -1;
+	}
+	t->joining = true;
+	mutex_unlock (&pool_lock);
+
+	status = thread_join (tid);
+
+	/* The thread is gone, so its stack and block can be reused. */
+	mutex_lock (&pool_lock);
+	t->in_use = false;
+	mutex_unlock (&pool_lock);
+
+	return status;
+}
+
+/* Ends the running thread with STATUS, which uthread_join()
+   returns.  In the initial thread, ends the process instead. */
+void
+uthread_exit (int status) {
+	thread_exit (status);
+}
+
+/* Returns the running thread's local value, a null pointer until
+   uthread_set_local() is called. */
+void *
+uthread_get_local (void) {
+	return uthread_self ()->local;
+}
+
+/* Sets the running thread's local value to LOCAL. */
+void
+uthread_set_local (void *local) {
+	uthread_self ()->local = local;
+}
@@ -0,0 +1,80 @@
+/* Checks that a thread that mostly sleeps stays responsive under
+   the completely fair scheduler while CPU-bound threads compete
+   for the CPU.
+
+   The main thread starts SPINNER_CNT threads that spin without
+   blocking, then sleeps for a few ticks ITERATION_CNT times.
+   Because it has used far less CPU time than the spinners, it
+   should preempt whichever one is running as soon as its timer
+   expires, instead of waiting for that thread's slice to run
+   out. */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/sched.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define SPINNER_CNT 3
+#define ITERATION_CNT 50
+
+static volatile bool done;
+static struct semaphore finished;
+
+static void spin_thread(void *aux);
+
+void test_cfs_sleeper(void)
+{
+  int64_t max_latency = 0;
+  int i;
+
+  ASSERT(thread_sched == &sched_cfs_class);
+
+  done = false;
+  sema_init(&finished, 0);
+
+  msg("Starting %d CPU-bound threads...", SPINNER_CNT);
+  for (i = 0; i < SPINNER_CNT; i++)
+  {
+    char name[16];
+
+    snprintf(name, sizeof name, "spin %d", i);
+    thread_create(name, PRI_DEFAULT, spin_thread, NULL);
+  }
+
+  /* Let the spinners settle into sharing the CPU. */
+  timer_sleep(TIMER_FREQ);
+
+  msg("Sleeping %d times...", ITERATION_CNT);
+  for (i = 0; i < ITERATION_CNT; i++)
+  {
+    int64_t wake_time = timer_ticks() + 3;
+    int64_t latency;
+
+    timer_sleep(3);
+    latency = timer_ticks() - wake_time;
+    if (latency > max_latency)
+      max_latency = latency;
+  }
+
+  done = true;
+  for (i = 0; i < SPINNER_CNT; i++)
+    sema_down(&finished);
+
+  /* A timer tick between reading wake_time and going to sleep
+     delays the wakeup by one tick, so allow for that. */
+  if (max_latency > 1)
+    fail("woke up as much as %" PRId64 " ticks late", max_latency);
+  msg("Woke up on time every time.");
+}
+
+static void
+spin_thread(void *aux UNUSED)
+{
+  while (!done)
+    continue;
+  sema_up(&finished);
+}
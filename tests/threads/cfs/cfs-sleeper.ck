@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(cfs-sleeper) begin
+(cfs-sleeper) Starting 3 CPU-bound threads...
+(cfs-sleeper) Sleeping 50 times...
+(cfs-sleeper) Woke up on time every time.
+(cfs-sleeper) end
+EOF
+pass;
@@ -0,0 +1,58 @@
+/* Checks admission control for EDF threads: registrations with
+   bad parameters or that would push the total bandwidth of EDF
+   threads past the limit are refused, replacing a thread's
+   parameters only counts its new bandwidth, and a thread gives
+   its bandwidth back when it exits. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+static thread_func edf_thread;
+static void try_deadline (int64_t runtime, int64_t period,
+                          int64_t deadline);
+
+void
+test_edf_admit (void) 
+{
+  struct semaphore done;
+
+  try_deadline (0, 10, 10);
+  try_deadline (6, 10, 5);
+  try_deadline (5, 10, 20);
+  try_deadline (5, 10, 10);
+
+  sema_init (&done, 0);
+  thread_create ("edf", PRI_DEFAULT, edf_thread, &done);
+  sema_down (&done);
+
+  /* Let the other thread exit. */
+  timer_sleep (2);
+
+  try_deadline (9, 10, 10);
+  try_deadline (10, 10, 10);
+  try_deadline (0, 0, 0);
+}
+
+static void
+edf_thread (void *done_) 
+{
+  struct semaphore *done = done_;
+
+  try_deadline (5, 10, 10);
+  try_deadline (4, 10, 10);
+  sema_up (done);
+}
+
+static void
+try_deadline (int64_t runtime, int64_t period, int64_t deadline) 
+{
+  bool ok = thread_set_deadline (runtime, period, deadline);
+
+  msg ("Thread %s: (%lld, %lld, %lld) %s.", thread_name (),
+       (long long) runtime, (long long) period, (long long) deadline,
+       ok ? "accepted" : "rejected");
+}
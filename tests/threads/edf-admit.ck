@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(edf-admit) begin
+(edf-admit) Thread main: (0, 10, 10) rejected.
+(edf-admit) Thread main: (6, 10, 5) rejected.
+(edf-admit) Thread main: (5, 10, 20) rejected.
+(edf-admit) Thread main: (5, 10, 10) accepted.
+(edf-admit) Thread edf: (5, 10, 10) rejected.
+(edf-admit) Thread edf: (4, 10, 10) accepted.
+(edf-admit) Thread main: (9, 10, 10) accepted.
+(edf-admit) Thread main: (10, 10, 10) rejected.
+(edf-admit) Thread main: (0, 0, 0) accepted.
+(edf-admit) end
+EOF
+pass;
@@ -0,0 +1,69 @@
+/* Checks that an EDF thread runs ahead of an ordinary thread but
+   is throttled once it has used its runtime for the period.
+
+   An EDF thread that asks for 2 ticks out of every 10 and an
+   ordinary thread both spin for 100 ticks, counting the timer
+   ticks they see.  The EDF thread should get about 20 ticks and
+   the ordinary thread the remaining 80 or so. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define SPIN_TICKS 100
+
+struct spinner 
+  {
+    int64_t start_time;
+    int tick_count;
+    bool edf;
+  };
+
+static thread_func spin_thread;
+
+void
+test_edf_throttle (void) 
+{
+  struct spinner edf, other;
+  int64_t start_time = timer_ticks () + 10;
+
+  edf.start_time = other.start_time = start_time;
+  edf.tick_count = other.tick_count = 0;
+  edf.edf = true;
+  other.edf = false;
+
+  msg ("Starting an EDF thread and an ordinary thread...");
+  thread_create ("edf", PRI_DEFAULT, spin_thread, &edf);
+  thread_create ("other", PRI_DEFAULT, spin_thread, &other);
+  timer_sleep (start_time + SPIN_TICKS + 10 - timer_ticks ());
+
+  if (edf.tick_count < 15 || edf.tick_count > 30)
+    fail ("EDF thread got %d ticks, expected about 20", edf.tick_count);
+  msg ("EDF thread got about 20 ticks.");
+  if (other.tick_count < 60)
+    fail ("ordinary thread got %d ticks, expected about 80",
+          other.tick_count);
+  msg ("Ordinary thread got the rest.");
+}
+
+static void
+spin_thread (void *s_) 
+{
+  struct spinner *s = s_;
+  int64_t last_time = 0;
+
+  if (s->edf && !thread_set_deadline (2, 10, 10))
+    fail ("thread_set_deadline (2, 10, 10) failed");
+
+  timer_sleep (s->start_time - timer_ticks ());
+  while (timer_ticks () < s->start_time + SPIN_TICKS) 
+    {
+      int64_t cur_time = timer_ticks ();
+      if (cur_time != last_time)
+        s->tick_count++;
+      last_time = cur_time;
+    }
+}
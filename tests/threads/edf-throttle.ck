@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(edf-throttle) begin
+(edf-throttle) Starting an EDF thread and an ordinary thread...
+(edf-throttle) EDF thread got about 20 ticks.
+(edf-throttle) Ordinary thread got the rest.
+(edf-throttle) end
+EOF
+pass;
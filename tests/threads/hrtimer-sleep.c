@@ -0,0 +1,74 @@
+/* Checks high-resolution sleeps: the clock never goes backward,
+   each sub-tick timer_usleep() lasts at least as long as asked,
+   and the sleeps block rather than spin, so that a lower-priority
+   thread gets to run while the main thread sleeps.  With a local
+   APIC timer, the sleeps must also end well before the next timer
+   tick would have woken them. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/hrtimer.h"
+#include "devices/lapic.h"
+#include "devices/timer.h"
+
+#define SLEEP_CNT 100
+#define SLEEP_US 200
+
+static volatile bool done;
+static volatile int64_t spins;
+static struct semaphore spinner_done;
+
+static thread_func spinner;
+
+void
+test_hrtimer_sleep (void)
+{
+  int64_t prev, now, start_ticks;
+  int i;
+
+  ASSERT (hrtimer_available ());
+
+  prev = hrtimer_now ();
+  for (i = 0; i < 1000; i++)
+    {
+      now = hrtimer_now ();
+      if (now < prev)
+        fail ("Clock went backward by %lld ns.", prev - now);
+      prev = now;
+    }
+  msg ("Clock is monotonic.");
+
+  sema_init (&spinner_done, 0);
+  thread_create ("spinner", PRI_DEFAULT - 1, spinner, NULL);
+
+  start_ticks = timer_ticks ();
+  for (i = 0; i < SLEEP_CNT; i++)
+    {
+      int64_t start = hrtimer_now ();
+      timer_usleep (SLEEP_US);
+      now = hrtimer_now ();
+      if (now - start < SLEEP_US * 1000)
+        fail ("Sleep %d lasted only %lld ns.", i, now - start);
+    }
+  msg ("%d sleeps of %d us each lasted long enough.", SLEEP_CNT, SLEEP_US);
+
+  if (lapic_present () && timer_elapsed (start_ticks) >= SLEEP_CNT / 2)
+    fail ("Sleeping took %lld ticks.", timer_elapsed (start_ticks));
+
+  done = true;
+  sema_down (&spinner_done);
+  if (spins == 0)
+    fail ("Lower-priority thread never ran while sleeping.");
+  msg ("Lower-priority thread ran while sleeping.");
+}
+
+static void
+spinner (void *aux UNUSED)
+{
+  while (!done)
+    spins++;
+  sema_up (&spinner_done);
+}
@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(hrtimer-sleep) begin
+(hrtimer-sleep) Clock is monotonic.
+(hrtimer-sleep) 100 sleeps of 200 us each lasted long enough.
+(hrtimer-sleep) Lower-priority thread ran while sleeping.
+(hrtimer-sleep) end
+EOF
+pass;
@@ -0,0 +1,75 @@
+/* Checks lock contention profiling: a named lock counts its
+   acquisitions and contended acquisitions, and charges wait and
+   hold times to it and the wait to the waiting call site.  Then
+   checks that unregistering the lock frees its statistics for
+   the next lock to be named. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/lockstat.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define HOLD_TICKS 3
+#define NS_PER_TICK (1000 * 1000 * 1000 / TIMER_FREQ)
+
+static struct lock lock;
+
+static thread_func waiter;
+
+void
+test_lockstat (void)
+{
+  struct lock_stats *s;
+  int i, callers = 0;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  lockstat_enabled = true;
+  lock_init_named (&lock, "test");
+  s = lock.stats;
+  ASSERT (s != NULL);
+
+  lock_acquire (&lock);
+  thread_create ("waiter", PRI_DEFAULT + 1, waiter, NULL);
+  timer_sleep (HOLD_TICKS);
+  lock_release (&lock);
+
+  msg ("%lld acquisitions, %lld contended.", s->acquired, s->contended);
+  if (s->wait_max < (HOLD_TICKS - 1) * NS_PER_TICK)
+    fail ("Longest wait %lld ns is too short.", (long long) s->wait_max);
+  if (s->wait_time != s->wait_max)
+    fail ("Total wait %lld ns differs from longest.", (long long) s->wait_time);
+  if (s->hold_max < (HOLD_TICKS - 1) * NS_PER_TICK)
+    fail ("Longest hold %lld ns is too short.", (long long) s->hold_max);
+  msg ("Wait and hold times cover the sleep.");
+
+  for (i = 0; i < LOCKSTAT_CALLERS; i++)
+    if (s->callers[i].addr != NULL)
+      {
+        callers++;
+        if (s->callers[i].waits != 1)
+          fail ("Call site waited %lld times.", s->callers[i].waits);
+      }
+  msg ("%d waiting call site recorded.", callers);
+
+  lockstat_unregister (s);
+  lock_init_named (&lock, "test2");
+  if (lock.stats != s)
+    fail ("Unregistered statistics were not reused.");
+  if (s->acquired != 0 || s->callers[0].addr != NULL)
+    fail ("Reused statistics were not reset.");
+  msg ("Unregistered statistics are reused.");
+  lockstat_unregister (lock.stats);
+  lockstat_enabled = false;
+}
+
+static void
+waiter (void *aux UNUSED)
+{
+  lock_acquire (&lock);
+  lock_release (&lock);
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(lockstat) begin
+(lockstat) 2 acquisitions, 1 contended.
+(lockstat) Wait and hold times cover the sleep.
+(lockstat) 1 waiting call site recorded.
+(lockstat) Unregistered statistics are reused.
+(lockstat) end
+EOF
+pass;
@@ -0,0 +1,134 @@
+/* Checks the SPSC ring buffer: full and empty rings, FIFO order
+   across the end of the array, partial batches, indexes that
+   overflow size_t, and a producer thread feeding a consumer
+   with no lock between them. */
+
+#include <ring.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "tests/threads/tests.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+#define RING_CNT 8
+#define STREAM_CNT 10000
+
+static struct ring ring;
+static int slots[RING_CNT];
+static struct semaphore producer_done;
+
+static thread_func producer;
+
+/* Fails unless RING holds exactly COUNT elements. */
+static void
+check_count (size_t count)
+{
+  if (ring_count (&ring) != count
+      || ring_space (&ring) != RING_CNT - count
+      || ring_empty (&ring) != (count == 0)
+      || ring_full (&ring) != (count == RING_CNT))
+    fail ("Ring holds %zu elements, expected %zu.", ring_count (&ring), count);
+}
+
+/* Pops CNT elements one at a time, failing unless they are NEXT,
+   NEXT + 1, ...  Returns the value after the last one. */
+static int
+pop_expect (size_t cnt, int next)
+{
+  int v;
+
+  for (; cnt > 0; cnt--, next++)
+    if (!ring_pop (&ring, &v) || v != next)
+      fail ("Popped %d, expected %d.", v, next);
+  return next;
+}
+
+void
+test_ring (void)
+{
+  int batch[RING_CNT * 2];
+  int next, expect, v;
+  size_t i, n;
+
+  ring_init (&ring, slots, RING_CNT, sizeof *slots);
+  check_count (0);
+  if (ring_pop (&ring, &v))
+    fail ("Popped from an empty ring.");
+
+  for (i = 0; i < RING_CNT; i++)
+    if (!ring_push (&ring, &(int) { i }))
+      fail ("Push %zu into a ring with room failed.", i);
+  check_count (RING_CNT);
+  if (ring_push (&ring, &(int) { -1 }))
+    fail ("Pushed into a full ring.");
+  msg ("Empty and full rings refuse pops and pushes.");
+
+  /* Free 3 slots and refill them, so that the ring's contents
+     run past the end of the array. */
+  next = pop_expect (3, 0);
+  for (i = RING_CNT; i < RING_CNT + 3; i++)
+    ring_push (&ring, &(int) { i });
+  check_count (RING_CNT);
+  next = pop_expect (RING_CNT, next);
+  check_count (0);
+  msg ("Elements come out in order across the wraparound.");
+
+  /* Batches that do not fit are cut short. */
+  for (i = 0; i < RING_CNT * 2; i++)
+    batch[i] = next + i;
+  n = ring_push_many (&ring, batch, 5);
+  if (n != 5)
+    fail ("Pushed %zu of 5 into an empty ring.", n);
+  n = ring_push_many (&ring, batch + 5, RING_CNT);
+  if (n != RING_CNT - 5)
+    fail ("Pushed %zu of %d into a ring with %d free slots.",
+          n, RING_CNT, RING_CNT - 5);
+  check_count (RING_CNT);
+  n = ring_pop_many (&ring, batch, RING_CNT * 2);
+  if (n != RING_CNT)
+    fail ("Popped %zu of %d from a full ring.", n, RING_CNT * 2);
+  for (i = 0; i < n; i++)
+    if (batch[i] != next + (int) i)
+      fail ("Batch element %zu is %d, expected %d.", i, batch[i], next + (int) i);
+  if (ring_pop_many (&ring, batch, 1) != 0 || ring_push_many (&ring, batch, 0) != 0)
+    fail ("Empty batches moved elements.");
+  msg ("Partial batches move as many elements as fit.");
+
+  /* The indexes count up forever and must survive overflowing. */
+  ring.head = ring.tail = SIZE_MAX - 2;
+  for (i = 0; i < 6; i++)
+    ring_push (&ring, &(int) { i });
+  check_count (6);
+  pop_expect (6, 0);
+  check_count (0);
+  msg ("Indexes wrap around SIZE_MAX.");
+
+  /* Stream through the ring with the producer in another thread. */
+  sema_init (&producer_done, 0);
+  thread_create ("producer", PRI_DEFAULT, producer, NULL);
+  for (expect = 0; expect < STREAM_CNT; )
+    {
+      n = ring_pop_many (&ring, batch, RING_CNT);
+      if (n == 0)
+        thread_yield ();
+      for (i = 0; i < n; i++, expect++)
+        if (batch[i] != expect)
+          fail ("Received %d, expected %d.", batch[i], expect);
+    }
+  sema_down (&producer_done);
+  check_count (0);
+  msg ("Consumer received %d elements in order.", STREAM_CNT);
+}
+
+static void
+producer (void *aux UNUSED)
+{
+  int i;
+
+  for (i = 0; i < STREAM_CNT; )
+    if (ring_push (&ring, &i))
+      i++;
+    else
+      thread_yield ();
+  sema_up (&producer_done);
+}
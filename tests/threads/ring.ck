@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(ring) begin
+(ring) Empty and full rings refuse pops and pushes.
+(ring) Elements come out in order across the wraparound.
+(ring) Partial batches move as many elements as fit.
+(ring) Indexes wrap around SIZE_MAX.
+(ring) Consumer received 10000 elements in order.
+(ring) end
+EOF
+pass;
@@ -0,0 +1,88 @@
+/* Measures how much a readers-writer lock lets readers overlap.
+
+   READER_CNT threads each take a lock ITERATIONS times and hold
+   it across a one-tick sleep, standing in for a blocking disk
+   read.  Under a plain lock the sleeps run one after another;
+   under a readers-writer lock, taken for reading, they overlap.
+   Prints the time taken each way.  The check only verifies that
+   the readers overlapped at all. */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define READER_CNT 4
+#define ITERATIONS 5
+
+static struct lock lock;
+static struct rwlock rwlock;
+static bool use_rwlock;
+static struct semaphore done;
+
+static thread_func reader;
+static int64_t run_readers (bool);
+
+void
+test_rwlock_bench (void)
+{
+  int64_t lock_ticks, rwlock_ticks;
+
+  lock_init (&lock);
+  rwlock_init (&rwlock);
+  sema_init (&done, 0);
+
+  lock_ticks = run_readers (false);
+  msg ("lock: %d readers took %"PRId64" ticks.", READER_CNT, lock_ticks);
+  rwlock_ticks = run_readers (true);
+  msg ("rwlock: %d readers took %"PRId64" ticks.", READER_CNT, rwlock_ticks);
+
+  if (rwlock_ticks * 2 > lock_ticks)
+    fail ("Readers did not overlap under the readers-writer lock.");
+  msg ("Readers ran %"PRId64".%02"PRId64" times faster.",
+       lock_ticks / rwlock_ticks, lock_ticks * 100 / rwlock_ticks % 100);
+}
+
+/* Runs READER_CNT readers to completion, using the readers-writer
+   lock if RW, and returns the number of ticks they took. */
+static int64_t
+run_readers (bool rw)
+{
+  int64_t start;
+  int i;
+
+  use_rwlock = rw;
+  start = timer_ticks ();
+  for (i = 0; i < READER_CNT; i++)
+    {
+      char name[16];
+      snprintf (name, sizeof name, "reader %d", i);
+      thread_create (name, PRI_DEFAULT, reader, NULL);
+    }
+  for (i = 0; i < READER_CNT; i++)
+    sema_down (&done);
+  return timer_elapsed (start);
+}
+
+static void
+reader (void *aux UNUSED)
+{
+  int i;
+
+  for (i = 0; i < ITERATIONS; i++)
+    {
+      if (use_rwlock)
+        rwlock_acquire_read (&rwlock);
+      else
+        lock_acquire (&lock);
+      timer_sleep (1);
+      if (use_rwlock)
+        rwlock_release_read (&rwlock);
+      else
+        lock_release (&lock);
+    }
+  sema_up (&done);
+}
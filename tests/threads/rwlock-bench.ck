@@ -0,0 +1,11 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+our ($test);
+my (@output) = read_text_file ("$test.output");
+common_checks ("run", @output);
+@output = get_core_output ("run", @output);
+fail "missing speedup\n"
+  if !grep (/^\(rwlock-bench\) Readers ran \d+\.\d\d times faster\.$/, @output);
+pass;
@@ -0,0 +1,74 @@
+/* Checks readers-writer locks: readers share the lock, a reader
+   that arrives while a writer waits queues behind it, the readers
+   waiting when a writer releases the lock get in ahead of other
+   writers, and waiters donate their priority to the writer that
+   holds the lock, including one that inherited it from the last
+   reader out. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+static struct rwlock rw;
+
+static thread_func reader_a, reader_b, reader_c, writer;
+
+void
+test_rwlock (void)
+{
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  /* Make sure our priority is the default. */
+  ASSERT (thread_get_priority () == PRI_DEFAULT);
+
+  rwlock_init (&rw);
+
+  rwlock_acquire_read (&rw);
+  thread_create ("reader-a", PRI_DEFAULT + 1, reader_a, NULL);
+  thread_create ("writer", PRI_DEFAULT + 1, writer, NULL);
+  thread_create ("reader-b", PRI_DEFAULT + 3, reader_b, NULL);
+  msg ("main: releasing read lock.");
+  rwlock_release_read (&rw);
+
+  rwlock_acquire_write (&rw);
+  thread_create ("reader-c", PRI_DEFAULT + 5, reader_c, NULL);
+  msg ("main: writing at priority %d.", thread_get_priority ());
+  rwlock_release_write (&rw);
+  msg ("main: back at priority %d.", thread_get_priority ());
+}
+
+static void
+reader_a (void *aux UNUSED)
+{
+  rwlock_acquire_read (&rw);
+  msg ("reader-a: reading alongside main.");
+  rwlock_release_read (&rw);
+}
+
+static void
+writer (void *aux UNUSED)
+{
+  rwlock_acquire_write (&rw);
+  msg ("writer: writing at priority %d.", thread_get_priority ());
+  rwlock_release_write (&rw);
+  msg ("writer: back at priority %d.", thread_get_priority ());
+}
+
+static void
+reader_b (void *aux UNUSED)
+{
+  rwlock_acquire_read (&rw);
+  msg ("reader-b: reading after the writer.");
+  rwlock_release_read (&rw);
+}
+
+static void
+reader_c (void *aux UNUSED)
+{
+  rwlock_acquire_read (&rw);
+  msg ("reader-c: reading after main.");
+  rwlock_release_read (&rw);
+}
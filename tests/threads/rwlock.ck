@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(rwlock) begin
+(rwlock) reader-a: reading alongside main.
+(rwlock) main: releasing read lock.
+(rwlock) writer: writing at priority 34.
+(rwlock) reader-b: reading after the writer.
+(rwlock) writer: back at priority 32.
+(rwlock) main: writing at priority 36.
+(rwlock) reader-c: reading after main.
+(rwlock) main: back at priority 31.
+(rwlock) end
+EOF
+pass;
@@ -0,0 +1,113 @@
+/* Checks sema_down_timeout() in three cases:
+
+   - The semaphore is upped before the deadline.  The waiter gets
+     it, and its timer event is canceled: once the deadline has
+     passed, the same thread blocked on another semaphore must
+     still be blocked there.
+
+   - Nobody ups the semaphore.  The call returns false after the
+     timeout, the waiter is off the wait queue, and a later
+     sema_up() leaves the value for the next caller.
+
+   - sema_up() wakes the waiter, but the deadline passes before
+     the waiter runs again.  The expiring timer must not touch
+     the already woken thread, and the waiter still gets the
+     semaphore. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define TIMEOUT 10
+
+static struct semaphore sema;
+static struct semaphore parked;
+static struct semaphore done;
+
+static volatile bool result;
+static volatile bool unparked;
+static volatile bool returned;
+static volatile int64_t deadline;
+
+static thread_func upped_waiter;
+static thread_func late_waiter;
+
+void
+test_sema_timeout (void)
+{
+  int64_t start;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  ASSERT (thread_get_priority () == PRI_DEFAULT);
+
+  sema_init (&sema, 0);
+  sema_init (&parked, 0);
+  sema_init (&done, 0);
+
+  /* Upped before the deadline. */
+  thread_create ("upped", PRI_DEFAULT + 1, upped_waiter, NULL);
+  sema_up (&sema);
+  if (!result)
+    fail ("sema_down_timeout() failed although the semaphore was upped.");
+  msg ("Upped semaphore acquired before the deadline.");
+
+  timer_sleep (TIMEOUT * 2);
+  if (unparked || waitq_empty (&parked.waiters))
+    fail ("Canceled timeout woke the waiter anyway.");
+  sema_up (&parked);
+  sema_down (&done);
+  msg ("Timeout canceled.");
+
+  /* Deadline passes. */
+  start = timer_ticks ();
+  if (sema_down_timeout (&sema, TIMEOUT))
+    fail ("sema_down_timeout() succeeded on a zero semaphore.");
+  if (timer_elapsed (start) < TIMEOUT)
+    fail ("sema_down_timeout() gave up after %lld of %d ticks.",
+          timer_elapsed (start), TIMEOUT);
+  if (!waitq_empty (&sema.waiters))
+    fail ("Timed-out waiter left on the wait queue.");
+  sema_up (&sema);
+  if (!sema_try_down (&sema))
+    fail ("sema_up() after a timeout did not raise the value.");
+  msg ("Timed out after %d ticks.", TIMEOUT);
+
+  /* Deadline passes after sema_up() woke the waiter. */
+  thread_create ("late", PRI_DEFAULT - 1, late_waiter, NULL);
+  timer_sleep (1);
+  sema_up (&sema);
+  while (timer_ticks () <= deadline + 1)
+    continue;
+  if (returned)
+    fail ("Lower-priority waiter ran before the main thread blocked.");
+  sema_down (&done);
+  if (!result)
+    fail ("Woken waiter lost the semaphore to its expired timeout.");
+  if (sema_try_down (&sema))
+    fail ("Semaphore value was not consumed.");
+  msg ("Woken waiter kept the semaphore past its deadline.");
+}
+
+static void
+upped_waiter (void *aux UNUSED)
+{
+  result = sema_down_timeout (&sema, TIMEOUT);
+  sema_down (&parked);
+  unparked = true;
+  sema_up (&done);
+}
+
+static void
+late_waiter (void *aux UNUSED)
+{
+  result = false;
+  deadline = timer_ticks () + TIMEOUT;
+  result = sema_down_timeout (&sema, TIMEOUT);
+  returned = true;
+  sema_up (&done);
+}
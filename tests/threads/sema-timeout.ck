@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(sema-timeout) begin
+(sema-timeout) Upped semaphore acquired before the deadline.
+(sema-timeout) Timeout canceled.
+(sema-timeout) Timed out after 10 ticks.
+(sema-timeout) Woken waiter kept the semaphore past its deadline.
+(sema-timeout) end
+EOF
+pass;
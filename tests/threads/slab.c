@@ -0,0 +1,80 @@
+/* Checks the slab allocator: objects from a cache are aligned as
+   requested, constructed once, distinct, and keep their
+   constructed state across free and reallocation, and a cache's
+   empty slabs go back to the page allocator. */
+
+#include <stdio.h>
+#include <stdint.h>
+#include "tests/threads/tests.h"
+#include "threads/slab.h"
+
+#define OBJ_CNT 60
+#define ALIGN 64
+#define CTOR_MAGIC 0x1234abcd
+
+struct object
+  {
+    unsigned magic;
+    int value;
+    char pad[192];
+  };
+
+static int ctor_cnt;
+
+static kmem_ctor_func construct;
+
+void
+test_slab (void)
+{
+  struct object *objs[OBJ_CNT];
+  struct kmem_cache *cache;
+  int i;
+
+  cache = kmem_cache_create ("test", sizeof (struct object), ALIGN, construct);
+  ASSERT (cache != NULL);
+
+  for (i = 0; i < OBJ_CNT; i++)
+    {
+      objs[i] = kmem_cache_alloc (cache);
+      if (objs[i] == NULL)
+        fail ("Allocation %d failed.", i);
+      if ((uintptr_t) objs[i] % ALIGN != 0)
+        fail ("Object %d at %p is misaligned.", i, objs[i]);
+      if (objs[i]->magic != CTOR_MAGIC)
+        fail ("Object %d was not constructed.", i);
+      objs[i]->value = i;
+    }
+  msg ("Allocated %d objects, all aligned and constructed.", OBJ_CNT);
+
+  for (i = 0; i < OBJ_CNT; i++)
+    if (objs[i]->value != i)
+      fail ("Object %d was overwritten.", i);
+  msg ("Objects do not overlap.");
+
+  for (i = 0; i < OBJ_CNT; i++)
+    kmem_cache_free (cache, objs[i]);
+  ctor_cnt = 0;
+  for (i = 0; i < OBJ_CNT; i++)
+    {
+      objs[i] = kmem_cache_alloc (cache);
+      if (objs[i] == NULL || objs[i]->magic != CTOR_MAGIC)
+        fail ("Reallocated object %d lost its constructed state.", i);
+    }
+  msg ("Reallocated objects keep their constructed state.");
+  if (ctor_cnt >= OBJ_CNT)
+    fail ("Constructor ran %d times for reallocated objects.", ctor_cnt);
+
+  for (i = 0; i < OBJ_CNT; i++)
+    kmem_cache_free (cache, objs[i]);
+  msg ("Shrinking freed %zu slab.", kmem_cache_shrink (cache));
+  kmem_cache_destroy (cache);
+}
+
+static void
+construct (void *obj_)
+{
+  struct object *obj = obj_;
+
+  obj->magic = CTOR_MAGIC;
+  ctor_cnt++;
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(slab) begin
+(slab) Allocated 60 objects, all aligned and constructed.
+(slab) Objects do not overlap.
+(slab) Reallocated objects keep their constructed state.
+(slab) Shrinking freed 1 slab.
+(slab) end
+EOF
+pass;
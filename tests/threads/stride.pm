@@ -0,0 +1,38 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::threads::mlfqs;
+
+# Returns the number of ticks each thread in a stride-fair test
+# should receive, given the threads' ticket counts: its share,
+# by tickets, of 30 seconds at 100 ticks per second.
+sub stride_expected_ticks {
+    my (@tickets) = @_;
+    my ($total) = 0;
+    $total += $_ foreach @tickets;
+    return map (3000 * $_ / $total, @tickets);
+}
+
+sub check_stride_fair {
+    my ($tickets, $maxdiff) = @_;
+    our ($test);
+    my (@output) = read_text_file ("$test.output");
+    common_checks ("run", @output);
+    @output = get_core_output ("run", @output);
+
+    my (@actual);
+    local ($_);
+    foreach (@output) {
+	my ($id, $count) = /Thread (\d+) received (\d+) ticks\./ or next;
+        $actual[$id] = $count;
+    }
+
+    my (@expected) = stride_expected_ticks (@$tickets);
+    mlfqs_compare ("thread", "%d",
+		   \@actual, \@expected, $maxdiff, [0, $#$tickets, 1],
+		   "Some tick counts were missing or differed from those "
+		   . "expected by more than $maxdiff.");
+    pass;
+}
+
+1;
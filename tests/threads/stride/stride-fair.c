@@ -0,0 +1,112 @@
+/* Checks that the stride scheduler divides the CPU among threads
+   in proportion to their tickets.
+
+   Each test starts a few threads with the given ticket counts,
+   lets them sleep 5 seconds so that they all wake up at once,
+   and then has them spin for 30 seconds, counting the timer
+   ticks they see.  Over 30 seconds there are about
+   30 * 100 == 3000 ticks to share, so:
+
+   stride-fair-2 runs 2 threads with 100 tickets each, which
+   should receive 1,500 ticks each.
+
+   stride-tickets-2 runs 2 threads with 100 and 300 tickets,
+   which should receive 750 and 2,250 ticks.
+
+   stride-tickets-4 runs 4 threads with 100, 200, 300 and 400
+   tickets, which should receive 300, 600, 900 and 1,200 ticks.
+
+   (The expected counts are computed in stride.pm.) */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/sched.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+static void test_stride_fair(int thread_cnt, const int tickets[]);
+
+void test_stride_fair_2(void)
+{
+  static const int tickets[] = {100, 100};
+  test_stride_fair(2, tickets);
+}
+
+void test_stride_tickets_2(void)
+{
+  static const int tickets[] = {100, 300};
+  test_stride_fair(2, tickets);
+}
+
+void test_stride_tickets_4(void)
+{
+  static const int tickets[] = {100, 200, 300, 400};
+  test_stride_fair(4, tickets);
+}
+
+#define MAX_THREAD_CNT 4
+
+struct thread_info
+{
+  int64_t start_time;
+  int tick_count;
+  int tickets;
+};
+
+static void load_thread(void *aux);
+
+static void
+test_stride_fair(int thread_cnt, const int tickets[])
+{
+  struct thread_info info[MAX_THREAD_CNT];
+  int64_t start_time;
+  int i;
+
+  ASSERT(thread_sched == &sched_stride_class);
+  ASSERT(thread_cnt <= MAX_THREAD_CNT);
+
+  start_time = timer_ticks();
+  msg("Starting %d threads...", thread_cnt);
+  for (i = 0; i < thread_cnt; i++)
+  {
+    struct thread_info *ti = &info[i];
+    char name[16];
+
+    ti->start_time = start_time;
+    ti->tick_count = 0;
+    ti->tickets = tickets[i];
+
+    snprintf(name, sizeof name, "load %d", i);
+    thread_create(name, PRI_DEFAULT, load_thread, ti);
+  }
+  msg("Starting threads took %" PRId64 " ticks.", timer_elapsed(start_time));
+
+  msg("Sleeping 40 seconds to let threads run, please wait...");
+  timer_sleep(40 * TIMER_FREQ);
+
+  for (i = 0; i < thread_cnt; i++)
+    msg("Thread %d received %d ticks.", i, info[i].tick_count);
+}
+
+static void
+load_thread(void *ti_)
+{
+  struct thread_info *ti = ti_;
+  int64_t sleep_time = 5 * TIMER_FREQ;
+  int64_t spin_time = sleep_time + 30 * TIMER_FREQ;
+  int64_t last_time = 0;
+
+  if (!thread_set_tickets(ti->tickets))
+    fail("thread_set_tickets(%d) failed", ti->tickets);
+  timer_sleep(sleep_time - timer_elapsed(ti->start_time));
+  while (timer_elapsed(ti->start_time) < spin_time)
+  {
+    int64_t cur_time = timer_ticks();
+    if (cur_time != last_time)
+      ti->tick_count++;
+    last_time = cur_time;
+  }
+}
@@ -0,0 +1,7 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+use tests::threads::stride;
+
+check_stride_fair ([100, 200, 300, 400], 50);
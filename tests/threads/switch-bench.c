@@ -0,0 +1,70 @@
+/* Measures context switch speed.
+
+   Two threads ping-pong over a pair of semaphores for
+   BENCH_SECONDS seconds: each round trip blocks each thread once,
+   so it costs two context switches.  Prints the number of
+   switches per second; the check only verifies that the
+   benchmark ran. */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define BENCH_SECONDS 2
+
+static struct semaphore ping, pong;
+static volatile bool done;
+
+static thread_func pong_thread;
+
+void
+test_switch_bench (void) 
+{
+  int64_t start, elapsed;
+  long long round_trips = 0;
+
+  sema_init (&ping, 0);
+  sema_init (&pong, 0);
+  done = false;
+  thread_create ("pong", PRI_DEFAULT, pong_thread, NULL);
+
+  /* Start on a tick boundary. */
+  start = timer_ticks ();
+  while (timer_ticks () == start)
+    continue;
+  start = timer_ticks ();
+
+  do
+    {
+      sema_up (&ping);
+      sema_down (&pong);
+      round_trips++;
+      elapsed = timer_elapsed (start);
+    }
+  while (elapsed < BENCH_SECONDS * TIMER_FREQ);
+
+  done = true;
+  sema_up (&ping);
+  sema_down (&pong);
+
+  msg ("%lld context switches in %"PRId64" ticks.",
+       round_trips * 2, elapsed);
+  msg ("%lld context switches per second.",
+       round_trips * 2 * TIMER_FREQ / elapsed);
+}
+
+static void
+pong_thread (void *aux UNUSED) 
+{
+  for (;;)
+    {
+      sema_down (&ping);
+      sema_up (&pong);
+      if (done)
+        break;
+    }
+}
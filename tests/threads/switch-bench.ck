@@ -0,0 +1,11 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+our ($test);
+my (@output) = read_text_file ("$test.output");
+common_checks ("run", @output);
+@output = get_core_output ("run", @output);
+fail "missing context switch count\n"
+  if !grep (/^\(switch-bench\) \d+ context switches per second\.$/, @output);
+pass;
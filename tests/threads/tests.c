@@ -29,6 +29,18 @@ static const struct test tests[] =
         {"priority-preempt", test_priority_preempt},
         {"priority-sema", test_priority_sema},
         {"priority-condvar", test_priority_condvar},
+        {"edf-admit", test_edf_admit},
+        {"edf-throttle", test_edf_throttle},
+        {"switch-bench", test_switch_bench},
+        {"workqueue", test_workqueue},
+        {"hrtimer-sleep", test_hrtimer_sleep},
+        {"rwlock", test_rwlock},
+        {"rwlock-bench", test_rwlock_bench},
+        {"lockstat", test_lockstat},
+        {"slab", test_slab},
+        {"vmalloc", test_vmalloc},
+        {"ring", test_ring},
+        {"sema-timeout", test_sema_timeout},
         {"mlfqs-load-1", test_mlfqs_load_1},
         {"mlfqs-load-60", test_mlfqs_load_60},
         {"mlfqs-load-avg", test_mlfqs_load_avg},
@@ -38,6 +50,13 @@ static const struct test tests[] =
         {"mlfqs-nice-2", test_mlfqs_nice_2},
         {"mlfqs-nice-10", test_mlfqs_nice_10},
         {"mlfqs-block", test_mlfqs_block},
+        {"stride-fair-2", test_stride_fair_2},
+        {"stride-tickets-2", test_stride_tickets_2},
+        {"stride-tickets-4", test_stride_tickets_4},
+        {"cfs-fair-2", test_cfs_fair_2},
+        {"cfs-nice-2", test_cfs_nice_2},
+        {"cfs-nice-4", test_cfs_nice_4},
+        {"cfs-sleeper", test_cfs_sleeper},
 };
 
 static const char *test_name;
@@ -23,6 +23,18 @@ extern test_func test_priority_fifo;
 extern test_func test_priority_preempt;
 extern test_func test_priority_sema;
 extern test_func test_priority_condvar;
+extern test_func test_edf_admit;
+extern test_func test_edf_throttle;
+extern test_func test_switch_bench;
+extern test_func test_workqueue;
+extern test_func test_hrtimer_sleep;
+extern test_func test_rwlock;
+extern test_func test_rwlock_bench;
+extern test_func test_lockstat;
+extern test_func test_slab;
+extern test_func test_vmalloc;
+extern test_func test_ring;
+extern test_func test_sema_timeout;
 extern test_func test_mlfqs_load_1;
 extern test_func test_mlfqs_load_60;
 extern test_func test_mlfqs_load_avg;
@@ -32,6 +44,13 @@ extern test_func test_mlfqs_fair_20;
 extern test_func test_mlfqs_nice_2;
 extern test_func test_mlfqs_nice_10;
 extern test_func test_mlfqs_block;
+extern test_func test_stride_fair_2;
+extern test_func test_stride_tickets_2;
+extern test_func test_stride_tickets_4;
+extern test_func test_cfs_fair_2;
+extern test_func test_cfs_nice_2;
+extern test_func test_cfs_nice_4;
+extern test_func test_cfs_sleeper;
 
 void msg (const char *, ...);
 void fail (const char *, ...);
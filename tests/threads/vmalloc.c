@@ -0,0 +1,43 @@
+/* Checks vmalloc(): a multi-page allocation lands in the vmalloc
+   range and holds data across all of its pages, and freeing it
+   gives back its virtual space. */
+
+#include <stdio.h>
+#include <stdint.h>
+#include "tests/threads/tests.h"
+#include "threads/vaddr.h"
+#include "threads/vmalloc.h"
+
+#define PAGE_CNT 16
+
+void
+test_vmalloc (void)
+{
+  size_t size = PAGE_CNT * PGSIZE - 100;
+  uint32_t *p, *q;
+  size_t i;
+
+  if (vmalloc (0) != NULL)
+    fail ("vmalloc(0) returned memory.");
+
+  p = vmalloc (size);
+  if (p == NULL)
+    fail ("vmalloc of %d pages failed.", PAGE_CNT);
+  if (!is_vmalloc_addr (p) || pg_ofs (p) != 0)
+    fail ("vmalloc returned %p, outside the vmalloc range.", p);
+  msg ("Allocated %d pages in the vmalloc range.", PAGE_CNT);
+
+  for (i = 0; i < size / sizeof *p; i++)
+    p[i] = i * 2654435761u;
+  for (i = 0; i < size / sizeof *p; i++)
+    if (p[i] != (uint32_t) (i * 2654435761u))
+      fail ("Word %zu reads back wrong.", i);
+  msg ("Data survives across all pages.");
+
+  vfree (p);
+  q = vmalloc (size);
+  if (q != p)
+    fail ("Reallocation at %p instead of %p.", q, p);
+  vfree (q);
+  msg ("Freed virtual space is reused.");
+}
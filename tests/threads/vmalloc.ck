@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(vmalloc) begin
+(vmalloc) Allocated 16 pages in the vmalloc range.
+(vmalloc) Data survives across all pages.
+(vmalloc) Freed virtual space is reused.
+(vmalloc) end
+EOF
+pass;
@@ -0,0 +1,118 @@
+/* Checks work queues: queued work runs in a worker thread,
+   queuing an item that is already pending does nothing,
+   flush_workqueue() waits for everything queued to finish, and
+   delayed work waits out its delay and can be canceled. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/workqueue.h"
+#include "devices/timer.h"
+
+#define WORK_CNT 5
+
+struct counter_work
+  {
+    struct work work;
+    int runs;
+    bool in_worker;
+  };
+
+static struct semaphore gate;
+static struct semaphore gate_entered;
+static int64_t delayed_ran_at;
+static struct thread *main_thread;
+
+static void gate_func (struct work *);
+static void counter_func (struct work *);
+static void delayed_func (struct work *);
+
+void
+test_workqueue (void)
+{
+  struct workqueue *wq;
+  struct work gate_work;
+  struct counter_work counters[WORK_CNT];
+  struct delayed_work delayed, canceled;
+  int64_t start;
+  int i, total;
+
+  main_thread = thread_current ();
+  wq = workqueue_create ("test", 1);
+  ASSERT (wq != NULL);
+
+  /* Hold the only worker so that nothing else can start. */
+  sema_init (&gate, 0);
+  sema_init (&gate_entered, 0);
+  work_init (&gate_work, gate_func);
+  queue_work (wq, &gate_work);
+  sema_down (&gate_entered);
+
+  for (i = 0; i < WORK_CNT; i++)
+    {
+      work_init (&counters[i].work, counter_func);
+      counters[i].runs = 0;
+      counters[i].in_worker = false;
+      if (!queue_work (wq, &counters[i].work))
+        fail ("queuing work %d failed", i);
+    }
+  msg ("Queuing a pending item again %s.",
+       queue_work (wq, &counters[0].work) ? "queued it" : "did nothing");
+
+  sema_up (&gate);
+  flush_workqueue (wq);
+
+  total = 0;
+  for (i = 0; i < WORK_CNT; i++)
+    {
+      if (!counters[i].in_worker)
+        fail ("work %d ran outside a worker thread", i);
+      total += counters[i].runs;
+    }
+  msg ("%d items ran %d times in all.", WORK_CNT, total);
+
+  /* Delayed work. */
+  delayed_work_init (&delayed, delayed_func);
+  delayed_work_init (&canceled, delayed_func);
+  delayed_ran_at = 0;
+  start = timer_ticks ();
+  queue_delayed_work (wq, &delayed, 10);
+  queue_delayed_work (wq, &canceled, 1000);
+  msg ("First cancel %s.",
+       cancel_delayed_work (&canceled) ? "succeeded" : "failed");
+  msg ("Second cancel %s.",
+       cancel_delayed_work (&canceled) ? "succeeded" : "failed");
+
+  timer_sleep (20);
+  flush_workqueue (wq);
+  if (delayed_ran_at == 0)
+    fail ("delayed work did not run");
+  if (delayed_ran_at - start < 10)
+    fail ("delayed work ran after %lld ticks, before its delay of 10",
+          (long long) (delayed_ran_at - start));
+  msg ("Delayed work waited out its delay.");
+}
+
+static void
+gate_func (struct work *w UNUSED)
+{
+  sema_up (&gate_entered);
+  sema_down (&gate);
+}
+
+static void
+counter_func (struct work *w)
+{
+  struct counter_work *cw = (struct counter_work *) w;
+
+  cw->runs++;
+  cw->in_worker = thread_current () != main_thread;
+}
+
+static void
+delayed_func (struct work *w UNUSED)
+{
+  delayed_ran_at = timer_ticks ();
+}
@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(workqueue) begin
+(workqueue) Queuing a pending item again did nothing.
+(workqueue) 5 items ran 5 times in all.
+(workqueue) First cancel succeeded.
+(workqueue) Second cancel failed.
+(workqueue) Delayed work waited out its delay.
+(workqueue) end
+EOF
+pass;
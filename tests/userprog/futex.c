@@ -0,0 +1,32 @@
+/* Checks futex_wait() and futex_wake() in a single process, and
+   that the user-space mutex and condition variable work without
+   contention. */
+
+#include <synch.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  struct mutex mutex = MUTEX_INITIALIZER;
+  struct condvar cond = CONDVAR_INITIALIZER;
+  int word = 1;
+
+  CHECK (futex_wait (&word, 0, -1) == -1, "futex_wait on changed word");
+  CHECK (futex_wait (&word, 1, 0) == -1, "futex_wait with zero timeout");
+  CHECK (futex_wait (&word, 1, 10) == -1, "futex_wait times out");
+  CHECK (futex_wake (&word, 1) == 0, "futex_wake with no waiters");
+
+  mutex_lock (&mutex);
+  CHECK (mutex.state == 1, "uncontended lock");
+  CHECK (!mutex_trylock (&mutex), "trylock of locked mutex fails");
+  condvar_signal (&cond);
+  condvar_broadcast (&cond);
+  CHECK (cond.seq == 0, "signal with no waiters");
+  mutex_unlock (&mutex);
+  CHECK (mutex.state == 0, "unlock");
+  CHECK (mutex_trylock (&mutex), "trylock of free mutex");
+  mutex_unlock (&mutex);
+}
@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(futex) begin
+(futex) futex_wait on changed word
+(futex) futex_wait with zero timeout
+(futex) futex_wait times out
+(futex) futex_wake with no waiters
+(futex) uncontended lock
+(futex) trylock of locked mutex fails
+(futex) signal with no waiters
+(futex) unlock
+(futex) trylock of free mutex
+(futex) end
+futex: exit(0)
+EOF
+pass;
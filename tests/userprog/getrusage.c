@@ -0,0 +1,45 @@
+/* Checks that getrusage() counts the bytes read and written by
+   the calling process, and that a child's usage shows up under
+   RUSAGE_CHILDREN once it has been waited for. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  struct rusage before, after, children;
+  char buf[sizeof sample];
+  int fd, pid;
+
+  CHECK ((fd = open ("sample.txt")) > 1, "open \"sample.txt\"");
+
+  /* No messages in between, since they count as writes. */
+  getrusage (RUSAGE_SELF, &before);
+  read (fd, buf, sizeof sample - 1);
+  getrusage (RUSAGE_SELF, &after);
+  CHECK (after.ru_inbytes - before.ru_inbytes == sizeof sample - 1,
+         "read counted");
+  CHECK (after.ru_outbytes == before.ru_outbytes, "no bytes written");
+
+  getrusage (RUSAGE_SELF, &before);
+  write (STDOUT_FILENO, "0123456789\n", 11);
+  getrusage (RUSAGE_SELF, &after);
+  CHECK (after.ru_outbytes - before.ru_outbytes == 11, "write counted");
+
+  CHECK (getrusage (RUSAGE_CHILDREN, &children) == 0, "getrusage children");
+  CHECK (children.ru_outbytes == 0, "no children waited for yet");
+
+  if ((pid = fork ("child-simple")) == 0)
+    exec ("child-simple");
+  msg ("wait(exec()) = %d", wait (pid));
+
+  getrusage (RUSAGE_CHILDREN, &children);
+  CHECK (children.ru_outbytes > 0, "child's writes counted");
+  CHECK (children.ru_nvcsw + children.ru_nivcsw > 0,
+         "child's context switches counted");
+  CHECK (getrusage (12345, &children) == -1, "getrusage bad who");
+}
@@ -0,0 +1,23 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(getrusage) begin
+(getrusage) open "sample.txt"
+(getrusage) read counted
+(getrusage) no bytes written
+0123456789
+(getrusage) write counted
+(getrusage) getrusage children
+(getrusage) no children waited for yet
+(child-simple) run
+child-simple: exit(81)
+(getrusage) wait(exec()) = 81
+(getrusage) child's writes counted
+(getrusage) child's context switches counted
+(getrusage) getrusage bad who
+(getrusage) end
+getrusage: exit(0)
+EOF
+pass;
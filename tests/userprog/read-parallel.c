@@ -0,0 +1,70 @@
+/* Benchmarks reads by concurrent processes.  Several children
+   read the same file at the same time, each through its own copy
+   of the descriptor, and check what they read.
+
+   read() takes filesys_lock only for reading, so a child can
+   start its next read while another one is blocked on the disk
+   inside file_read().  Run with -lockstat, the .ck file checks
+   in the lock statistics that the children rarely had to wait
+   for filesys_lock at all.  Under an exclusive lock nearly every
+   read would wait. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define CHILD_CNT 4
+#define FILE_SIZE (16 * 1024)
+#define CHUNK_SIZE 512
+#define PASSES 4
+
+static char data[FILE_SIZE];
+
+/* Reads the file open as FD from start to end PASSES times.
+   Returns 0 if every read returned the right bytes, otherwise
+   1 more than the pass that went wrong. */
+static int
+read_file (int fd)
+{
+  char chunk[CHUNK_SIZE];
+  int pass;
+  size_t ofs;
+
+  for (pass = 0; pass < PASSES; pass++)
+    {
+      seek (fd, 0);
+      for (ofs = 0; ofs < FILE_SIZE; ofs += CHUNK_SIZE)
+        if (read (fd, chunk, CHUNK_SIZE) != CHUNK_SIZE
+            || memcmp (chunk, data + ofs, CHUNK_SIZE))
+          return pass + 1;
+    }
+  return 0;
+}
+
+void
+test_main (void)
+{
+  int pids[CHILD_CNT];
+  int status[CHILD_CNT];
+  size_t i;
+  int fd;
+
+  for (i = 0; i < FILE_SIZE; i++)
+    data[i] = i * 7 + i / 256;
+  CHECK (create ("bench.dat", 0), "create \"bench.dat\"");
+  CHECK ((fd = open ("bench.dat")) > 1, "open \"bench.dat\"");
+  CHECK (write (fd, data, FILE_SIZE) == FILE_SIZE, "write \"bench.dat\"");
+
+  /* No messages until every child is done, since writing to the
+     console takes filesys_lock exclusively. */
+  for (i = 0; i < CHILD_CNT; i++)
+    if ((pids[i] = fork ("reader")) == 0)
+      exit (read_file (fd));
+  for (i = 0; i < CHILD_CNT; i++)
+    status[i] = wait (pids[i]);
+
+  for (i = 0; i < CHILD_CNT; i++)
+    CHECK (status[i] == 0, "reader %zu read the file %d times", i, PASSES);
+  close (fd);
+}
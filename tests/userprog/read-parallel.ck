@@ -0,0 +1,32 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+our ($test);
+check_expected ([<<'EOF']);
+(read-parallel) begin
+(read-parallel) create "bench.dat"
+(read-parallel) open "bench.dat"
+(read-parallel) write "bench.dat"
+reader: exit(0)
+reader: exit(0)
+reader: exit(0)
+reader: exit(0)
+(read-parallel) reader 0 read the file 4 times
+(read-parallel) reader 1 read the file 4 times
+(read-parallel) reader 2 read the file 4 times
+(read-parallel) reader 3 read the file 4 times
+(read-parallel) end
+read-parallel: exit(0)
+EOF
+
+# The children made 4 * 4 * 32 reads.  Only the few exclusive
+# acquisitions, by write() and close(), may make anybody wait.
+my ($acquired, $contended);
+foreach (read_text_file ("$test.output")) {
+    ($acquired, $contended) = /^filesys\s+(\d+)\s+(\d+)\s/ and last;
+}
+fail "filesys_lock missing from lock statistics\n" if !defined $acquired;
+fail "filesys_lock contended $contended times in $acquired acquisitions\n"
+  if $contended * 10 > $acquired;
+pass;
@@ -0,0 +1,27 @@
+/* Calls exit() in a second thread while the initial thread is
+   asleep on a condition variable that is never signaled.  The
+   whole process must end with the second thread's status. */
+
+#include <synch.h>
+#include <syscall.h>
+#include <uthread.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static struct mutex mutex = MUTEX_INITIALIZER;
+static struct condvar never = CONDVAR_INITIALIZER;
+
+static int
+exiter (void *aux UNUSED)
+{
+  exit (57);
+}
+
+void
+test_main (void)
+{
+  mutex_lock (&mutex);
+  CHECK (uthread_create (exiter, NULL) != TID_ERROR, "create thread");
+  for (;;)
+    condvar_wait (&never, &mutex);
+}
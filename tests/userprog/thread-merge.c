@@ -0,0 +1,144 @@
+/* Generates 64 kB of random data that is then divided into 8
+   chunks.  A separate thread sorts each chunk in place; the
+   threads run in parallel and, sharing the address space, need
+   no files to pass the data around.  Then we merge the chunks
+   and verify that the result is what it should be.  Modeled on
+   tests/vm/parallel-merge, which uses child processes. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include <uthread.h>
+#include "tests/arc4.h"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define CHUNK_SIZE (8 * 1024)
+#define CHUNK_CNT 8                             /* Number of chunks. */
+#define DATA_SIZE (CHUNK_CNT * CHUNK_SIZE)      /* Buffer size. */
+
+unsigned char buf1[DATA_SIZE], buf2[DATA_SIZE];
+size_t histogram[256];
+
+/* Initialize buf1 with random data,
+   then count the number of instances of each value within it. */
+static void
+init (void)
+{
+  struct arc4 arc4;
+  size_t i;
+
+  msg ("init");
+
+  arc4_init (&arc4, "foobar", 6);
+  arc4_crypt (&arc4, buf1, sizeof buf1);
+  for (i = 0; i < sizeof buf1; i++)
+    histogram[buf1[i]]++;
+}
+
+/* Sorts the CHUNK_SIZE bytes at CHUNK_ using counting sort. */
+static int
+sort_chunk (void *chunk_)
+{
+  unsigned char *chunk = chunk_;
+  size_t counts[256] = { 0 };
+  unsigned char *p;
+  size_t i;
+
+  for (i = 0; i < CHUNK_SIZE; i++)
+    counts[chunk[i]]++;
+  p = chunk;
+  for (i = 0; i < sizeof counts / sizeof *counts; i++)
+    {
+      size_t j = counts[i];
+      while (j-- > 0)
+        *p++ = i;
+    }
+  return 123;
+}
+
+/* Sort each chunk of buf1 in its own thread. */
+static void
+sort_chunks (void)
+{
+  tid_t threads[CHUNK_CNT];
+  size_t i;
+
+  for (i = 0; i < CHUNK_CNT; i++)
+    {
+      msg ("sort chunk %zu", i);
+      CHECK ((threads[i] = uthread_create (sort_chunk,
+                                           buf1 + CHUNK_SIZE * i))
+             != TID_ERROR, "create thread %zu", i);
+    }
+
+  for (i = 0; i < CHUNK_CNT; i++)
+    CHECK (uthread_join (threads[i]) == 123, "join thread %zu", i);
+}
+
+/* Merge the sorted chunks in buf1 into a fully sorted buf2. */
+static void
+merge (void)
+{
+  unsigned char *mp[CHUNK_CNT];
+  size_t mp_left;
+  unsigned char *op;
+  size_t i;
+
+  msg ("merge");
+
+  /* Initialize merge pointers. */
+  mp_left = CHUNK_CNT;
+  for (i = 0; i < CHUNK_CNT; i++)
+    mp[i] = buf1 + CHUNK_SIZE * i;
+
+  /* Merge. */
+  op = buf2;
+  while (mp_left > 0)
+    {
+      /* Find smallest value. */
+      size_t min = 0;
+      for (i = 1; i < mp_left; i++)
+        if (*mp[i] < *mp[min])
+          min = i;
+
+      /* Append value to buf2. */
+      *op++ = *mp[min];
+
+      /* Advance merge pointer.
+         Delete this chunk from the set if it's emptied. */
+      if ((++mp[min] - buf1) % CHUNK_SIZE == 0)
+        mp[min] = mp[--mp_left];
+    }
+}
+
+static void
+verify (void)
+{
+  size_t buf_idx;
+  size_t hist_idx;
+
+  msg ("verify");
+
+  buf_idx = 0;
+  for (hist_idx = 0; hist_idx < sizeof histogram / sizeof *histogram;
+       hist_idx++)
+    {
+      while (histogram[hist_idx]-- > 0)
+        {
+          if (buf2[buf_idx] != hist_idx)
+            fail ("bad value %d in byte %zu", buf2[buf_idx], buf_idx);
+          buf_idx++;
+        }
+    }
+
+  msg ("success, buf_idx=%'zu", buf_idx);
+}
+
+void
+test_main (void)
+{
+  init ();
+  sort_chunks ();
+  merge ();
+  verify ();
+}
@@ -0,0 +1,38 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(thread-merge) begin
+(thread-merge) init
+(thread-merge) sort chunk 0
+(thread-merge) create thread 0
+(thread-merge) sort chunk 1
+(thread-merge) create thread 1
+(thread-merge) sort chunk 2
+(thread-merge) create thread 2
+(thread-merge) sort chunk 3
+(thread-merge) create thread 3
+(thread-merge) sort chunk 4
+(thread-merge) create thread 4
+(thread-merge) sort chunk 5
+(thread-merge) create thread 5
+(thread-merge) sort chunk 6
+(thread-merge) create thread 6
+(thread-merge) sort chunk 7
+(thread-merge) create thread 7
+(thread-merge) join thread 0
+(thread-merge) join thread 1
+(thread-merge) join thread 2
+(thread-merge) join thread 3
+(thread-merge) join thread 4
+(thread-merge) join thread 5
+(thread-merge) join thread 6
+(thread-merge) join thread 7
+(thread-merge) merge
+(thread-merge) verify
+(thread-merge) success, buf_idx=65,536
+(thread-merge) end
+thread-merge: exit(0)
+EOF
+pass;
@@ -0,0 +1,67 @@
+/* Runs several threads that read one file through the same file
+   descriptor, a byte at a time, while the main thread reads it
+   too.  The threads share the file position, so between them
+   they must read every byte of the file exactly once. */
+
+#include <stdint.h>
+#include <syscall.h>
+#include <uthread.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define THREAD_CNT 4
+
+static int handle;
+static int counts[THREAD_CNT + 1][256];
+
+/* Reads HANDLE to the end, counting each byte value under ID. */
+static int
+reader (void *id_)
+{
+  int id = (intptr_t) id_;
+  unsigned char c;
+  int bytes = 0;
+
+  while (read (handle, &c, 1) == 1)
+    {
+      counts[id][c]++;
+      bytes++;
+    }
+  return bytes;
+}
+
+void
+test_main (void)
+{
+  tid_t threads[THREAD_CNT];
+  int expected[256] = { 0 };
+  int total;
+  size_t i;
+  int v;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  for (i = 0; i < THREAD_CNT; i++)
+    CHECK ((threads[i] = uthread_create (reader, (void *) (intptr_t) i)) != TID_ERROR,
+           "create thread %zu", i);
+  total = reader ((void *) THREAD_CNT);
+  for (i = 0; i < THREAD_CNT; i++)
+    total += uthread_join (threads[i]);
+  msg ("join threads");
+
+  if (total != (int) sizeof sample - 1)
+    fail ("read %d bytes in total, file is %zu bytes", total, sizeof sample - 1);
+  for (i = 0; i < sizeof sample - 1; i++)
+    expected[(unsigned char) sample[i]]++;
+  for (v = 0; v < 256; v++)
+    {
+      int got = 0;
+
+      for (i = 0; i <= THREAD_CNT; i++)
+        got += counts[i][v];
+      if (got != expected[v])
+        fail ("byte %d read %d times, expected %d", v, got, expected[v]);
+    }
+  msg ("every byte read once");
+  close (handle);
+}
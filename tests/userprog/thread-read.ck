@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(thread-read) begin
+(thread-read) open "sample.txt"
+(thread-read) create thread 0
+(thread-read) create thread 1
+(thread-read) create thread 2
+(thread-read) create thread 3
+(thread-read) join threads
+(thread-read) every byte read once
+(thread-read) end
+thread-read: exit(0)
+EOF
+pass;
@@ -0,0 +1,82 @@
+/* Checks that getrusage() reports the usage of the whole process,
+   not just of the calling thread: bytes read by a second thread
+   count under RUSAGE_SELF while that thread runs and after it has
+   been joined, and under the parent's RUSAGE_CHILDREN when the
+   thread belongs to a child process. */
+
+#include <synch.h>
+#include <syscall.h>
+#include <uthread.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define SIZE ((int) sizeof sample - 1)
+
+static int handle;
+static char buf[sizeof sample];
+
+static struct mutex mutex = MUTEX_INITIALIZER;
+static struct condvar cond = CONDVAR_INITIALIZER;
+static bool done_reading, may_exit;
+
+/* Reads the whole file, then waits until the main thread lets
+   it exit. */
+static int
+reader (void *aux UNUSED)
+{
+  seek (handle, 0);
+  read (handle, buf, SIZE);
+
+  mutex_lock (&mutex);
+  done_reading = true;
+  condvar_broadcast (&cond);
+  while (!may_exit)
+    condvar_wait (&cond, &mutex);
+  mutex_unlock (&mutex);
+  return 0;
+}
+
+/* Reads the whole file and exits right away. */
+static int
+quick_reader (void *aux UNUSED)
+{
+  seek (handle, 0);
+  return read (handle, buf, SIZE);
+}
+
+void
+test_main (void)
+{
+  struct rusage before, after, children;
+  tid_t tid;
+  int pid;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+
+  getrusage (RUSAGE_SELF, &before);
+  CHECK ((tid = uthread_create (reader, NULL)) != TID_ERROR, "create thread");
+  mutex_lock (&mutex);
+  while (!done_reading)
+    condvar_wait (&cond, &mutex);
+  getrusage (RUSAGE_SELF, &after);
+  may_exit = true;
+  condvar_broadcast (&cond);
+  mutex_unlock (&mutex);
+  CHECK (after.ru_inbytes - before.ru_inbytes == SIZE,
+         "running thread's read counted");
+
+  uthread_join (tid);
+  getrusage (RUSAGE_SELF, &after);
+  CHECK (after.ru_inbytes - before.ru_inbytes == SIZE,
+         "joined thread's read still counted once");
+
+  if ((pid = fork ("thread-rusage-child")) == 0)
+    {
+      uthread_join (uthread_create (quick_reader, NULL));
+      exit (0);
+    }
+  CHECK (wait (pid) == 0, "wait for child");
+  getrusage (RUSAGE_CHILDREN, &children);
+  CHECK (children.ru_inbytes == SIZE, "child's thread's read counted");
+}
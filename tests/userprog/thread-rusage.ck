@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(thread-rusage) begin
+(thread-rusage) open "sample.txt"
+(thread-rusage) create thread
+(thread-rusage) running thread's read counted
+(thread-rusage) joined thread's read still counted once
+thread-rusage-child: exit(0)
+(thread-rusage) wait for child
+(thread-rusage) child's thread's read counted
+(thread-rusage) end
+thread-rusage: exit(0)
+EOF
+pass;
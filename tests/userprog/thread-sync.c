@@ -0,0 +1,64 @@
+/* Runs several threads that update shared data under a mutex,
+   wait for each other on a condition variable, and keep their
+   own thread-local values, then checks the results. */
+
+#include <stdint.h>
+#include <synch.h>
+#include <syscall.h>
+#include <uthread.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define THREAD_CNT 4
+#define ITERATIONS 1000
+
+static struct mutex mutex = MUTEX_INITIALIZER;
+static struct condvar all_arrived = CONDVAR_INITIALIZER;
+static int counter;
+static int arrived;
+
+static int
+worker (void *id_)
+{
+  int id = (intptr_t) id_;
+  int i;
+
+  uthread_set_local (id_);
+
+  for (i = 0; i < ITERATIONS; i++)
+    {
+      mutex_lock (&mutex);
+      counter++;
+      mutex_unlock (&mutex);
+    }
+
+  /* Barrier: nobody goes on until everybody has counted. */
+  mutex_lock (&mutex);
+  if (++arrived == THREAD_CNT)
+    condvar_broadcast (&all_arrived);
+  while (arrived < THREAD_CNT)
+    condvar_wait (&all_arrived, &mutex);
+  mutex_unlock (&mutex);
+
+  if ((intptr_t) uthread_get_local () != id)
+    return -1;
+  return id * 10;
+}
+
+void
+test_main (void)
+{
+  tid_t threads[THREAD_CNT];
+  int i;
+
+  uthread_set_local ((void *) 99);
+  for (i = 0; i < THREAD_CNT; i++)
+    CHECK ((threads[i] = uthread_create (worker, (void *) (intptr_t) i)) != TID_ERROR,
+           "create thread %d", i);
+  for (i = 0; i < THREAD_CNT; i++)
+    CHECK (uthread_join (threads[i]) == i * 10, "join thread %d", i);
+
+  CHECK (uthread_join (threads[0]) == -1, "second join fails");
+  CHECK (counter == THREAD_CNT * ITERATIONS, "counter is %d", counter);
+  CHECK ((intptr_t) uthread_get_local () == 99, "initial thread's local value");
+}
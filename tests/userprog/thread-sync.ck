@@ -0,0 +1,21 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(thread-sync) begin
+(thread-sync) create thread 0
+(thread-sync) create thread 1
+(thread-sync) create thread 2
+(thread-sync) create thread 3
+(thread-sync) join thread 0
+(thread-sync) join thread 1
+(thread-sync) join thread 2
+(thread-sync) join thread 3
+(thread-sync) second join fails
+(thread-sync) counter is 4000
+(thread-sync) initial thread's local value
+(thread-sync) end
+thread-sync: exit(0)
+EOF
+pass;
@@ -8,6 +8,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "devices/hrtimer.h"
 #include "devices/kbd.h"
 #include "devices/input.h"
 #include "devices/serial.h"
@@ -16,11 +17,17 @@
 #include "threads/interrupt.h"
 #include "threads/io.h"
 #include "threads/loader.h"
+#include "threads/lockstat.h"
 #include "threads/malloc.h"
 #include "threads/mmu.h"
 #include "threads/palloc.h"
 #include "threads/pte.h"
+#include "threads/sched.h"
+#include "threads/slab.h"
 #include "threads/thread.h"
+#include "threads/trace.h"
+#include "threads/vmalloc.h"
+#include "threads/workqueue.h"
 #ifdef USERPROG
 #include "userprog/process.h"
 #include "userprog/exception.h"
@@ -49,6 +56,9 @@ static bool format_filesys;
 /* -q: Power off after kernel tasks complete? */
 bool power_off_when_done;
 
+/* -trace: Dump the scheduler trace when powering off? */
+static bool trace_on_power_off;
+
 bool thread_tests;
 
 static void bss_init(void);
@@ -80,12 +90,15 @@ int main(void)
 	/* Initialize ourselves as a thread so we can use locks,
 		 then enable console locking. */
 	thread_init(); // 스레드로 자신을 초기화하여 잠금을 사용할 수 있게 한다
+	trace_init(); // 스케줄러 트레이스 시작 시점 기록
 	console_init(); // 콘솔 잠금을 활성화 
 
 	/* Initialize memory system. */
 	mem_end = palloc_init(); // 페이지 할당 초기화
 	malloc_init(); // 동적 메모리 할당 초기화
+	kmem_init(); // 고정 크기 객체용 슬랩 캐시 초기화
 	paging_init(mem_end); // 페이징 시스템 초기화
+	vmalloc_init(); // 흩어진 페이지를 이어 붙여 매핑할 가상 주소 영역 초기화
 
 #ifdef USERPROG
 	tss_init();
@@ -103,8 +116,10 @@ int main(void)
 #endif
 	/* Start thread scheduler and enable interrupts. */
 	thread_start(); // 스레드 스케줄러 시작
+	workqueue_init(); // 공용 워크큐와 워커 스레드 생성
 	serial_init_queue();
 	timer_calibrate();
+	hrtimer_init(); // TSC와 로컬 APIC 타이머 보정, 고해상도 타이머 시작
 
 #ifdef FILESYS
 	/* Initialize file system. */
@@ -227,7 +242,20 @@ parse_options(char **argv)
 		else if (!strcmp(name, "-rs"))
 			random_init(atoi(value));
 		else if (!strcmp(name, "-mlfqs"))
+		{
 			thread_mlfqs = true;
+			thread_sched = &sched_mlfqs_class;
+		}
+		else if (!strcmp(name, "-stride"))
+			thread_sched = &sched_stride_class;
+		else if (!strcmp(name, "-cfs"))
+			thread_sched = &sched_cfs_class;
+		else if (!strcmp(name, "-tickless"))
+			timer_tickless = true;
+		else if (!strcmp(name, "-trace"))
+			trace_on_power_off = true;
+		else if (!strcmp(name, "-lockstat"))
+			lockstat_enabled = true;
 #ifdef USERPROG
 		else if (!strcmp(name, "-ul"))
 			user_page_limit = atoi(value);
@@ -263,6 +291,20 @@ run_task(char **argv)
 	printf("Execution of '%s' complete.\n", task);
 }
 
+/* Dumps the scheduler trace. */
+static void
+run_trace(char **argv UNUSED)
+{
+	trace_dump();
+}
+
+/* Prints the lock statistics gathered so far. */
+static void
+run_lockstat(char **argv UNUSED)
+{
+	lockstat_print_stats();
+}
+
 /* Executes all of the actions specified in ARGV[]
 	 up to the null pointer sentinel. */
 static void
@@ -279,6 +321,8 @@ run_actions(char **argv)
 	/* Table of supported actions. */
 	static const struct action actions[] = {
 			{"run", 2, run_task},
+			{"trace", 1, run_trace},
+			{"lockstat", 1, run_lockstat},
 #ifdef FILESYS
 			{"ls", 1, fsutil_ls},
 			{"cat", 2, fsutil_cat},
@@ -326,6 +370,8 @@ usage(void)
 #else
 				 "  run TEST           Run TEST.\n"
 #endif
+				 "  trace              Dump the scheduler trace.\n"
+				 "  lockstat           Print lock statistics (with -lockstat).\n"
 #ifdef FILESYS
 				 "  ls                 List files in the root directory.\n"
 				 "  cat FILE           Print FILE to the console.\n"
@@ -340,6 +386,11 @@ usage(void)
 				 "  -f                 Format file system disk during startup.\n"
 				 "  -rs=SEED           Set random number seed to SEED.\n"
 				 "  -mlfqs             Use multi-level feedback queue scheduler.\n"
+				 "  -stride            Use stride scheduler, sharing CPU by tickets.\n"
+				 "  -cfs               Use completely fair scheduler, weighted by nice.\n"
+				 "  -tickless          Stop the timer tick while the CPU is idle.\n"
+				 "  -trace             Dump the scheduler trace when powering off.\n"
+				 "  -lockstat          Profile lock contention; print it when powering off.\n"
 #ifdef USERPROG
 				 "  -ul=COUNT          Limit user memory to COUNT pages.\n"
 #endif
@@ -355,6 +406,8 @@ void power_off(void)
 	filesys_done();
 #endif
 
+	if (trace_on_power_off)
+		trace_dump();
 	print_stats();
 
 	printf("Powering off...\n");
@@ -369,6 +422,9 @@ print_stats(void)
 {
 	timer_print_stats();
 	thread_print_stats();
+	palloc_print_stats();
+	kmem_print_stats();
+	lockstat_print_stats();
 #ifdef FILESYS
 	disk_print_stats();
 #endif
@@ -9,10 +9,12 @@
 #include "threads/thread.h"
 #include "threads/mmu.h"
 #include "threads/vaddr.h"
+#include "devices/lapic.h"
 #include "devices/timer.h"
 #include "intrinsic.h"
 #ifdef USERPROG
 #include "userprog/gdt.h"
+#include "userprog/process.h"
 #endif
 
 /* Number of x86_64 interrupts. */
@@ -227,7 +229,8 @@ register_handler (uint8_t vec_no, int dpl, enum intr_level level,
 void
 intr_register_ext (uint8_t vec_no, intr_handler_func *handler,
 		const char *name) {
-	ASSERT (vec_no >= 0x20 && vec_no <= 0x2f);
+	ASSERT ((vec_no >= 0x20 && vec_no <= 0x2f)
+	        || (vec_no >= LAPIC_VEC_MIN && vec_no <= LAPIC_VEC_MAX));
 	register_handler (vec_no, 0, INTR_OFF, handler, name);
 }
 
@@ -335,22 +338,29 @@ intr_handler (struct intr_frame *frame) {
 
 	/* External interrupts are special.
 	   We only handle one at a time (so interrupts must be off)
-	   and they need to be acknowledged on the PIC (see below).
+	   and they need to be acknowledged on the PIC, or on the local
+	   APIC for the vectors it delivers (see below).
 	   An external interrupt handler cannot sleep. */
-	external = frame->vec_no >= 0x20 && frame->vec_no < 0x30;
+	external = (frame->vec_no >= 0x20 && frame->vec_no < 0x30)
+		|| (frame->vec_no >= LAPIC_VEC_MIN && frame->vec_no <= LAPIC_VEC_MAX);
 	if (external) {
 		ASSERT (intr_get_level () == INTR_OFF);
 		ASSERT (!intr_context ());
 
 		in_external_intr = true;
 		yield_on_return = false;
+
+		/* Bring the tick count up to date if the idle CPU had
+		   stopped the periodic timer. */
+		timer_irq_enter ();
 	}
 
 	/* Invoke the interrupt's handler. */
 	handler = intr_handlers[frame->vec_no];
 	if (handler != NULL)
 		handler (frame);
-	else if (frame->vec_no == 0x27 || frame->vec_no == 0x2f) {
+	else if (frame->vec_no == 0x27 || frame->vec_no == 0x2f
+	         || frame->vec_no == LAPIC_SPURIOUS_VEC) {
 		/* There is no handler, but this interrupt can trigger
 		   spuriously due to a hardware fault or hardware race
 		   condition.  Ignore it. */
@@ -367,10 +377,21 @@ intr_handler (struct intr_frame *frame) {
 		ASSERT (intr_context ());
 
 		in_external_intr = false;
-		pic_end_of_interrupt (frame->vec_no);
+		if (frame->vec_no >= LAPIC_VEC_MIN)
+			lapic_eoi ();
+		else
+			pic_end_of_interrupt (frame->vec_no);
 
 		if (yield_on_return)
 			thread_yield ();
+
+#ifdef USERPROG
+		/* Don't resume a user thread whose process is exiting. */
+		if ((frame->cs & 3) == 3 && thread_current ()->leader->exiting) {
+			intr_enable ();
+			process_check_exiting ();
+		}
+#endif
 	}
 }
 
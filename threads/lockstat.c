@@ -0,0 +1,174 @@
+#include "threads/lockstat.h"
+#include <debug.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/interrupt.h"
+#include "devices/hrtimer.h"
+
+/* Maximum number of named locks. */
+#define LOCKSTAT_MAX 32
+
+/* -lockstat: Profile named locks? */
+bool lockstat_enabled;
+
+/* Registered locks.  Locks are named while the kernel boots,
+   before malloc() works, so their statistics come from here. */
+static struct lock_stats stats[LOCKSTAT_MAX];
+
+/* Returns fresh statistics for a lock named NAME, or a null
+   pointer if there is no more room, in which case the lock just
+   goes unprofiled. */
+struct lock_stats *
+lockstat_register (const char *name) {
+	struct lock_stats *s;
+	enum intr_level old_level;
+
+	ASSERT (name != NULL);
+
+	old_level = intr_disable ();
+	for (s = stats; s < stats + LOCKSTAT_MAX; s++)
+		if (!s->in_use) {
+			memset (s, 0, sizeof *s);
+			s->in_use = true;
+			strlcpy (s->name, name, sizeof s->name);
+			break;
+		}
+	intr_set_level (old_level);
+	return s < stats + LOCKSTAT_MAX ? s : NULL;
+}
+
+/* Frees S, which lockstat_register() returned for a lock that is
+   about to go away, for another lock to use.  Its statistics are
+   dropped.  S may be a null pointer. */
+void
+lockstat_unregister (struct lock_stats *s) {
+	enum intr_level old_level;
+
+	if (s == NULL)
+		return;
+
+	ASSERT (s->in_use);
+	old_level = intr_disable ();
+	s->in_use = false;
+	intr_set_level (old_level);
+}
+
+/* Returns the time to pass to lockstat_acquired() as the start of
+   a wait. */
+int64_t
+lockstat_now (void) {
+	return hrtimer_now ();
+}
+
+/* Records an acquisition of the lock S describes by CALLER.
+   WAIT_START is the lockstat_now() value at which the caller
+   started to wait, or -1 if it did not have to.  If HOLD, the
+   caller is the lock's only holder, and the hold lasts until
+   lockstat_released(). */
+void
+lockstat_acquired (struct lock_stats *s, int64_t wait_start, void *caller,
+                   bool hold) {
+	enum intr_level old_level = intr_disable ();
+	int64_t now = hrtimer_now ();
+
+	s->acquired++;
+	if (wait_start >= 0) {
+		int64_t wait = now - wait_start;
+		struct lockstat_caller *c, *victim = &s->callers[0];
+
+		s->contended++;
+		s->wait_time += wait;
+		if (wait > s->wait_max)
+			s->wait_max = wait;
+
+		/* Charge the wait to CALLER's slot, or take over the slot
+		   of the call site that has waited least. */
+		for (c = s->callers; c < s->callers + LOCKSTAT_CALLERS; c++) {
+			if (c->addr == caller)
+				break;
+			if (c->wait_time < victim->wait_time)
+				victim = c;
+		}
+		if (c == s->callers + LOCKSTAT_CALLERS) {
+			c = victim;
+			c->addr = caller;
+			c->waits = 0;
+			c->wait_time = 0;
+		}
+		c->waits++;
+		c->wait_time += wait;
+	}
+	if (hold)
+		s->hold_start = now;
+	intr_set_level (old_level);
+}
+
+/* Records the end of the hold that lockstat_acquired() started. */
+void
+lockstat_released (struct lock_stats *s) {
+	enum intr_level old_level = intr_disable ();
+	int64_t hold = hrtimer_now () - s->hold_start;
+
+	s->hold_time += hold;
+	if (hold > s->hold_max)
+		s->hold_max = hold;
+	intr_set_level (old_level);
+}
+
+/* Prints S's waiting call sites, longest total wait first. */
+static void
+print_callers (const struct lock_stats *s) {
+	struct lockstat_caller callers[LOCKSTAT_CALLERS];
+	size_t i, j;
+
+	/* Insertion sort. */
+	for (i = 0; i < LOCKSTAT_CALLERS; i++) {
+		struct lockstat_caller c = s->callers[i];
+		for (j = i; j > 0 && callers[j - 1].wait_time < c.wait_time; j--)
+			callers[j] = callers[j - 1];
+		callers[j] = c;
+	}
+
+	for (i = 0; i < LOCKSTAT_CALLERS; i++)
+		if (callers[i].addr != NULL)
+			printf ("  waiter %p: %lld waits, %lld us\n", callers[i].addr,
+			        callers[i].waits, (long long) callers[i].wait_time / 1000);
+}
+
+/* Prints the statistics of every named lock that was acquired,
+   most waited-for first, with its top waiting call sites.  Pass
+   the addresses to the "backtrace" utility to find the callers. */
+void
+lockstat_print_stats (void) {
+	bool printed[LOCKSTAT_MAX];
+	size_t i, j;
+
+	if (!lockstat_enabled)
+		return;
+
+	printf ("Lock statistics (times in us):\n");
+	printf ("%-16s %10s %10s %12s %10s %12s %10s\n", "name", "acquired",
+	        "contended", "wait total", "wait max", "hold total", "hold max");
+	memset (printed, 0, sizeof printed);
+	for (i = 0; i < LOCKSTAT_MAX; i++) {
+		struct lock_stats *s = NULL;
+
+		for (j = 0; j < LOCKSTAT_MAX; j++)
+			if (stats[j].in_use && !printed[j]
+			    && (s == NULL || stats[j].wait_time > s->wait_time))
+				s = &stats[j];
+		if (s == NULL)
+			break;
+		printed[s - stats] = true;
+		if (s->acquired == 0)
+			continue;
+
+		printf ("%-16s %10lld %10lld %12lld %10lld %12lld %10lld\n",
+		        s->name, s->acquired, s->contended,
+		        (long long) s->wait_time / 1000,
+		        (long long) s->wait_max / 1000,
+		        (long long) s->hold_time / 1000,
+		        (long long) s->hold_max / 1000);
+		print_callers (s);
+	}
+}
@@ -8,6 +8,7 @@
 #include "threads/palloc.h"
 #include "threads/synch.h"
 #include "threads/vaddr.h"
+#include "threads/vmalloc.h"
 
 /* A simple implementation of malloc().
 
@@ -32,7 +33,9 @@
    because they're too big to fit in a single page with a
    descriptor.  We handle those by allocating contiguous pages
    with the page allocator and sticking the allocation size at
-   the beginning of the allocated block's arena header. */
+   the beginning of the allocated block's arena header.  If no
+   run of contiguous pages is free, we map scattered pages with
+   vmalloc() instead; see kvmalloc(). */
 
 /* Descriptor. */
 struct desc {
@@ -71,11 +74,13 @@ malloc_init (void) {
 
 	for (block_size = 16; block_size < PGSIZE / 2; block_size *= 2) {
 		struct desc *d = &descs[desc_cnt++];
+		char name[16];
 		ASSERT (desc_cnt <= sizeof descs / sizeof *descs);
 		d->block_size = block_size;
 		d->blocks_per_arena = (PGSIZE - sizeof (struct arena)) / block_size;
 		list_init (&d->free_list);
-		lock_init (&d->lock);
+		snprintf (name, sizeof name, "malloc %zu", block_size);
+		lock_init_named (&d->lock, name);
 	}
 }
 
@@ -100,7 +105,7 @@ malloc (size_t size) {
 		/* SIZE is too big for any descriptor.
 		   Allocate enough pages to hold SIZE plus an arena. */
 		size_t page_cnt = DIV_ROUND_UP (size + sizeof *a, PGSIZE);
-		a = palloc_get_multiple (0, page_cnt);
+		a = kvmalloc (page_cnt * PGSIZE);
 		if (a == NULL)
 			return NULL;
 
@@ -233,7 +238,7 @@ free (void *p) {
 			lock_release (&d->lock);
 		} else {
 			/* It's a big block.  Free its pages. */
-			palloc_free_multiple (a, a->free_cnt);
+			kvfree (a, a->free_cnt * PGSIZE);
 			return;
 		}
 	}
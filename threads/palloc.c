@@ -2,12 +2,15 @@
 #include <bitmap.h>
 #include <debug.h>
 #include <inttypes.h>
+#include <list.h>
 #include <round.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include "threads/cpu.h"
 #include "threads/init.h"
+#include "threads/interrupt.h"
 #include "threads/loader.h"
 #include "threads/synch.h"
 #include "threads/vaddr.h"
@@ -24,12 +27,75 @@
 
    By default, half of system RAM is given to the kernel pool and
    half to the user pool.  That should be huge overkill for the
-   kernel pool, but that's just fine for demonstration purposes. */
+   kernel pool, but that's just fine for demonstration purposes.
+
+   Each pool is a binary buddy allocator.  Free memory is kept as
+   blocks of 2**K pages, for "orders" K from 0 to MAX_ORDER, each
+   aligned to its own size relative to the pool base.  A block's
+   "buddy" is the other half of the block of the next higher
+   order that contains it, so the buddy of the order-K block at
+   page index I is at I ^ (1 << K).  Allocating takes the first
+   free block of a high enough order and splits it in halves down
+   to the order needed, and freeing merges a block with its buddy
+   for as long as the buddy is free too, so both take O(lg n)
+   time.  A request that is not a power of 2 gets the block that
+   fits it, less the tail pages, which are freed again at once.
+
+   The free lists thread through the free pages themselves.  The
+   pools are protected by disabling interrupts, plus a spinlock,
+   rather than by a lock, because the scheduler frees the pages
+   of dead threads with interrupts off.  The spinlocks are named,
+   so -lockstat still reports the pools' contention.
+
+   Most requests are for a single page, so in front of the buddy
+   lists each CPU keeps a "magazine" of free pages for each pool.
+   Single pages are taken from and returned to the magazine with
+   only interrupts disabled.  An empty magazine is refilled with
+   MAG_LOW pages, and a full one gives its MAG_HIGH - MAG_LOW
+   coldest pages back, each under a single hold of the pool lock.
+   Pages in a magazine are still marked used in the pool's
+   bitmap.  palloc_drain() empties all of the magazines, and an
+   allocation that fails drains them and tries once more.
+
+   Each pool also keeps up to ZERO_MAX free pages that are already
+   filled with zeros, so that single-page PAL_ZERO requests need
+   not clear a page while the caller waits.  The idle thread
+   refills them through palloc_prezero() when no thread is ready
+   to run, and palloc_drain() gives them back too. */
+
+/* Largest order of block, as a power of 2 pages. */
+#define MAX_ORDER 20
+
+/* free_order[] value for a page that does not start a free
+   block. */
+#define NOT_FREE 0xff
+
+/* Magazine watermarks: the most pages that a magazine holds, and
+   the number that it holds after being refilled or trimmed. */
+#define MAG_HIGH 32
+#define MAG_LOW 16
+
+/* Most pre-zeroed pages that a pool keeps. */
+#define ZERO_MAX 64
+
+/* A CPU's cache of free single pages from one pool. */
+struct magazine {
+	size_t cnt;                     /* Number of pages cached. */
+	void *pages[MAG_HIGH];          /* Pages, coldest first. */
+};
 
 /* A memory pool. */
 struct pool {
-	struct lock lock;               /* Mutual exclusion. */
-	struct bitmap *used_map;        /* Bitmap of free pages. */
+	struct spinlock lock;           /* Mutual exclusion. */
+	struct magazine mags[MAX_CPUS]; /* Cached free pages, per CPU. */
+	void *zeroed[ZERO_MAX];         /* Free pages already zeroed. */
+	size_t zeroed_cnt;              /* Number of pages in zeroed[]. */
+	long long zero_hits;            /* PAL_ZERO pages served from zeroed[]. */
+	long long zero_misses;          /* PAL_ZERO pages zeroed on demand. */
+	struct bitmap *used_map;        /* Bitmap of pages in use. */
+	uint8_t *free_order;            /* Order of the free block at each page. */
+	struct list free_lists[MAX_ORDER + 1]; /* Free blocks, by order. */
+	size_t free_cnt;                /* Number of free pages. */
 	uint8_t *base;                  /* Base of pool. */
 };
 
@@ -42,6 +108,17 @@ static void
 init_pool (struct pool *p, void **bm_base, uint64_t start, uint64_t end);
 
 static bool page_from_pool (const struct pool *, void *page);
+static void *pool_page (const struct pool *, size_t page_idx);
+static size_t pool_page_idx (const struct pool *, void *page);
+static void *get_pages (struct pool *, size_t page_cnt);
+static void *get_zeroed_page (struct pool *);
+static bool prezero_page (struct pool *);
+static size_t take_pages (struct pool *, size_t page_cnt);
+static void give_pages (struct pool *, size_t page_idx, size_t page_cnt);
+static size_t drain_pool (struct pool *);
+static size_t buddy_alloc (struct pool *, int order);
+static void free_range (struct pool *, size_t page_idx, size_t page_cnt);
+static void print_pool_stats (const char *name, struct pool *);
 
 /* multiboot info */
 struct multiboot_info {
@@ -220,15 +297,17 @@ split:
 				NOT_REACHED ();
 
 			pool_end = pool->base + bitmap_size (pool->used_map) * PGSIZE;
-			page_idx = pg_no (start) - pg_no (pool->base);
+			page_idx = pool_page_idx (pool, (void *) start);
 			if ((uint64_t) pool_end < end) {
 				page_cnt = ((uint64_t) pool_end - start) / PGSIZE;
 				bitmap_set_multiple (pool->used_map, page_idx, page_cnt, false);
+				free_range (pool, page_idx, page_cnt);
 				start = (uint64_t) pool_end;
 				goto split;
 			} else {
 				page_cnt = ((uint64_t) end - start) / PGSIZE;
 				bitmap_set_multiple (pool->used_map, page_idx, page_cnt, false);
+				free_range (pool, page_idx, page_cnt);
 			}
 		}
 	}
@@ -262,16 +341,20 @@ palloc_init (void) {
 void *
 palloc_get_multiple (enum palloc_flags flags, size_t page_cnt) {
 	struct pool *pool = flags & PAL_USER ? &user_pool : &kernel_pool;
-
-	lock_acquire (&pool->lock);
-	size_t page_idx = bitmap_scan_and_flip (pool->used_map, 0, page_cnt, false);
-	lock_release (&pool->lock);
 	void *pages;
 
-	if (page_idx != BITMAP_ERROR)
-		pages = pool->base + PGSIZE * page_idx;
-	else
-		pages = NULL;
+	if (page_cnt == 0)
+		return NULL;
+
+	if ((flags & PAL_ZERO) && page_cnt == 1) {
+		pages = get_zeroed_page (pool);
+		if (pages != NULL)
+			return pages;
+	}
+
+	pages = get_pages (pool, page_cnt);
+	if (pages == NULL && palloc_drain () > 0)
+		pages = get_pages (pool, page_cnt);
 
 	if (pages) {
 		if (flags & PAL_ZERO)
@@ -300,7 +383,7 @@ palloc_get_page (enum palloc_flags flags) {
 void
 palloc_free_multiple (void *pages, size_t page_cnt) {
 	struct pool *pool;
-	size_t page_idx;
+	enum intr_level old_level;
 
 	ASSERT (pg_ofs (pages) == 0);
 	if (pages == NULL || page_cnt == 0)
@@ -313,13 +396,36 @@ palloc_free_multiple (void *pages, size_t page_cnt) {
 	else
 		NOT_REACHED ();
 
-	page_idx = pg_no (pages) - pg_no (pool->base);
-
 #ifndef NDEBUG
 	memset (pages, 0xcc, PGSIZE * page_cnt);
 #endif
-	ASSERT (bitmap_all (pool->used_map, page_idx, page_cnt));
-	bitmap_set_multiple (pool->used_map, page_idx, page_cnt, false);
+	old_level = intr_disable ();
+	if (page_cnt == 1) {
+		struct magazine *mag = &pool->mags[this_cpu ()->id];
+		size_t i;
+
+		ASSERT (bitmap_test (pool->used_map, pool_page_idx (pool, pages)));
+		for (i = 0; i < mag->cnt; i++)
+			ASSERT (mag->pages[i] != pages);
+
+		if (mag->cnt == MAG_HIGH) {
+			/* Full: give back the coldest pages. */
+			size_t trim = MAG_HIGH - MAG_LOW;
+
+			spinlock_acquire (&pool->lock);
+			for (i = 0; i < trim; i++)
+				give_pages (pool, pool_page_idx (pool, mag->pages[i]), 1);
+			spinlock_release (&pool->lock);
+			memmove (mag->pages, mag->pages + trim, MAG_LOW * sizeof *mag->pages);
+			mag->cnt = MAG_LOW;
+		}
+		mag->pages[mag->cnt++] = pages;
+	} else {
+		spinlock_acquire (&pool->lock);
+		give_pages (pool, pool_page_idx (pool, pages), page_cnt);
+		spinlock_release (&pool->lock);
+	}
+	intr_set_level (old_level);
 }
 
 /* Frees the page at PAGE. */
@@ -328,21 +434,198 @@ palloc_free_page (void *page) {
 	palloc_free_multiple (page, 1);
 }
 
+/* Returns the pages cached in every CPU's magazines, and the
+   pre-zeroed pages, to their pools, where they can merge into
+   larger blocks again.  Meant for when memory runs short.
+   Returns the number of pages returned. */
+size_t
+palloc_drain (void) {
+	return drain_pool (&kernel_pool) + drain_pool (&user_pool);
+}
+
+/* Zeroes a free page ahead of a PAL_ZERO request, taking it from
+   the kernel pool or, if that has enough zeroed pages already,
+   the user pool.  Called by the idle thread with interrupts on.
+   Returns false if there was nothing to do because both pools
+   have ZERO_MAX zeroed pages or are out of free pages. */
+bool
+palloc_prezero (void) {
+	return prezero_page (&kernel_pool) || prezero_page (&user_pool);
+}
+
+/* Takes a page off POOL's pre-zeroed pages and returns it, or
+   returns a null pointer if there are none.  Counts the request
+   as a hit or a miss. */
+static void *
+get_zeroed_page (struct pool *pool) {
+	enum intr_level old_level;
+	void *page = NULL;
+
+	old_level = intr_disable ();
+	spinlock_acquire (&pool->lock);
+	if (pool->zeroed_cnt > 0) {
+		page = pool->zeroed[--pool->zeroed_cnt];
+		pool->zero_hits++;
+	} else
+		pool->zero_misses++;
+	spinlock_release (&pool->lock);
+	intr_set_level (old_level);
+
+	return page;
+}
+
+/* Zeroes one free page of POOL and adds it to POOL's pre-zeroed
+   pages, unless POOL already has ZERO_MAX of them or no free
+   pages.  Returns true if a page was zeroed. */
+static bool
+prezero_page (struct pool *pool) {
+	enum intr_level old_level;
+	size_t page_idx = BITMAP_ERROR;
+	void *page;
+
+	old_level = intr_disable ();
+	spinlock_acquire (&pool->lock);
+	if (pool->zeroed_cnt < ZERO_MAX)
+		page_idx = take_pages (pool, 1);
+	spinlock_release (&pool->lock);
+	intr_set_level (old_level);
+	if (page_idx == BITMAP_ERROR)
+		return false;
+
+	/* Zero it without holding anything, so that interrupts, and
+	   through them threads that wake up, are not held off. */
+	page = pool_page (pool, page_idx);
+	memset (page, 0, PGSIZE);
+
+	old_level = intr_disable ();
+	spinlock_acquire (&pool->lock);
+	if (pool->zeroed_cnt < ZERO_MAX)
+		pool->zeroed[pool->zeroed_cnt++] = page;
+	else
+		give_pages (pool, page_idx, 1);
+	spinlock_release (&pool->lock);
+	intr_set_level (old_level);
+
+	return true;
+}
+
+/* Obtains PAGE_CNT contiguous pages from POOL, taking a single
+   page from the running CPU's magazine.  Returns a null pointer
+   if too few pages are available. */
+static void *
+get_pages (struct pool *pool, size_t page_cnt) {
+	enum intr_level old_level;
+	void *pages = NULL;
+	size_t page_idx;
+
+	old_level = intr_disable ();
+	if (page_cnt == 1) {
+		struct magazine *mag = &pool->mags[this_cpu ()->id];
+
+		if (mag->cnt == 0) {
+			/* Empty: refill up to the low watermark. */
+			spinlock_acquire (&pool->lock);
+			while (mag->cnt < MAG_LOW
+			       && (page_idx = take_pages (pool, 1)) != BITMAP_ERROR)
+				mag->pages[mag->cnt++] = pool_page (pool, page_idx);
+			spinlock_release (&pool->lock);
+		}
+		if (mag->cnt > 0)
+			pages = mag->pages[--mag->cnt];
+	} else {
+		spinlock_acquire (&pool->lock);
+		page_idx = take_pages (pool, page_cnt);
+		spinlock_release (&pool->lock);
+		if (page_idx != BITMAP_ERROR)
+			pages = pool_page (pool, page_idx);
+	}
+	intr_set_level (old_level);
+
+	return pages;
+}
+
+/* Allocates PAGE_CNT contiguous pages from POOL's buddy lists and
+   returns the index of the first one, or BITMAP_ERROR if too few
+   pages are available.  POOL's lock must be held. */
+static size_t
+take_pages (struct pool *pool, size_t page_cnt) {
+	size_t page_idx;
+	int order = 0;
+
+	while (((size_t) 1 << order) < page_cnt)
+		if (++order > MAX_ORDER)
+			return BITMAP_ERROR;
+
+	page_idx = buddy_alloc (pool, order);
+	if (page_idx != BITMAP_ERROR) {
+		pool->free_cnt -= (size_t) 1 << order;
+		free_range (pool, page_idx + page_cnt,
+		            ((size_t) 1 << order) - page_cnt);
+		bitmap_set_multiple (pool->used_map, page_idx, page_cnt, true);
+	}
+	return page_idx;
+}
+
+/* Returns the PAGE_CNT pages starting at PAGE_IDX to POOL's
+   buddy lists.  POOL's lock must be held. */
+static void
+give_pages (struct pool *pool, size_t page_idx, size_t page_cnt) {
+	ASSERT (bitmap_all (pool->used_map, page_idx, page_cnt));
+	bitmap_set_multiple (pool->used_map, page_idx, page_cnt, false);
+	free_range (pool, page_idx, page_cnt);
+}
+
+/* Empties every CPU's magazine for POOL, and POOL's pre-zeroed
+   pages, back into POOL and returns the number of pages freed. */
+static size_t
+drain_pool (struct pool *pool) {
+	enum intr_level old_level;
+	size_t drained = 0;
+	int i;
+
+	old_level = intr_disable ();
+	spinlock_acquire (&pool->lock);
+	for (i = 0; i < cpu_cnt; i++) {
+		struct magazine *mag = &pool->mags[i];
+
+		while (mag->cnt > 0) {
+			give_pages (pool, pool_page_idx (pool, mag->pages[--mag->cnt]), 1);
+			drained++;
+		}
+	}
+	while (pool->zeroed_cnt > 0) {
+		give_pages (pool, pool_page_idx (pool, pool->zeroed[--pool->zeroed_cnt]), 1);
+		drained++;
+	}
+	spinlock_release (&pool->lock);
+	intr_set_level (old_level);
+
+	return drained;
+}
+
 /* Initializes pool P as starting at START and ending at END */
 static void
 init_pool (struct pool *p, void **bm_base, uint64_t start, uint64_t end) {
-  /* We'll put the pool's used_map at its base.
-     Calculate the space needed for the bitmap
+  /* We'll put the pool's used_map at its base, followed by
+     its free_order array.
+     Calculate the space needed for them
      and subtract it from the pool's size. */
 	uint64_t pgcnt = (end - start) / PGSIZE;
-	size_t bm_pages = DIV_ROUND_UP (bitmap_buf_size (pgcnt), PGSIZE) * PGSIZE;
-
-	lock_init(&p->lock);
-	p->used_map = bitmap_create_in_buf (pgcnt, *bm_base, bm_pages);
+	size_t bm_size = bitmap_buf_size (pgcnt);
+	size_t bm_pages = DIV_ROUND_UP (bm_size + pgcnt, PGSIZE) * PGSIZE;
+	int order;
+
+	spinlock_init_named (&p->lock, p == &kernel_pool ? "kernel pool" : "user pool");
+	p->used_map = bitmap_create_in_buf (pgcnt, *bm_base, bm_size);
+	p->free_order = (uint8_t *) *bm_base + bm_size;
+	for (order = 0; order <= MAX_ORDER; order++)
+		list_init (&p->free_lists[order]);
+	p->free_cnt = 0;
 	p->base = (void *) start;
 
 	// Mark all to unusable.
 	bitmap_set_all(p->used_map, true);
+	memset (p->free_order, NOT_FREE, pgcnt);
 
 	*bm_base += bm_pages;
 }
@@ -356,3 +639,148 @@ page_from_pool (const struct pool *pool, void *page) {
 	size_t end_page = start_page + bitmap_size (pool->used_map);
 	return page_no >= start_page && page_no < end_page;
 }
+
+/* Returns the kernel virtual address of page PAGE_IDX in POOL. */
+static void *
+pool_page (const struct pool *pool, size_t page_idx) {
+	return pool->base + PGSIZE * page_idx;
+}
+
+/* Returns the index of PAGE within POOL. */
+static size_t
+pool_page_idx (const struct pool *pool, void *page) {
+	return pg_no (page) - pg_no (pool->base);
+}
+
+
+/* Puts the block of 2**ORDER pages at PAGE_IDX on POOL's free
+   list for ORDER.  The list element lives in the block's first
+   page. */
+static void
+push_block (struct pool *pool, size_t page_idx, int order) {
+	pool->free_order[page_idx] = order;
+	list_push_front (&pool->free_lists[order], pool_page (pool, page_idx));
+}
+
+/* Takes the free block at PAGE_IDX off its free list. */
+static void
+remove_block (struct pool *pool, size_t page_idx) {
+	ASSERT (pool->free_order[page_idx] != NOT_FREE);
+
+	list_remove (pool_page (pool, page_idx));
+	pool->free_order[page_idx] = NOT_FREE;
+}
+
+/* Takes a block of 2**ORDER pages off POOL's free lists,
+   splitting a larger block if there is none that size, and
+   returns the index of its first page, or BITMAP_ERROR if there
+   is no block that large.  Does not update the free page
+   count. */
+static size_t
+buddy_alloc (struct pool *pool, int order) {
+	size_t page_idx;
+	int k;
+
+	for (k = order; k <= MAX_ORDER; k++)
+		if (!list_empty (&pool->free_lists[k]))
+			break;
+	if (k > MAX_ORDER)
+		return BITMAP_ERROR;
+
+	page_idx = pool_page_idx (pool, list_front (&pool->free_lists[k]));
+	remove_block (pool, page_idx);
+
+	/* Give back the upper half until the block is small enough. */
+	while (k > order) {
+		k--;
+		push_block (pool, page_idx + ((size_t) 1 << k), k);
+	}
+	return page_idx;
+}
+
+/* Frees the block of 2**ORDER pages at PAGE_IDX, merging it with
+   its buddy for as long as the buddy is free as a whole. */
+static void
+buddy_free (struct pool *pool, size_t page_idx, int order) {
+	while (order < MAX_ORDER) {
+		size_t buddy = page_idx ^ ((size_t) 1 << order);
+
+		if (buddy >= bitmap_size (pool->used_map)
+		    || pool->free_order[buddy] != order)
+			break;
+		remove_block (pool, buddy);
+		page_idx &= ~((size_t) 1 << order);
+		order++;
+	}
+	push_block (pool, page_idx, order);
+}
+
+/* Frees the PAGE_CNT pages starting at PAGE_IDX in POOL, as the
+   largest aligned blocks that they can be divided into. */
+static void
+free_range (struct pool *pool, size_t page_idx, size_t page_cnt) {
+	pool->free_cnt += page_cnt;
+	while (page_cnt > 0) {
+		int order = 0;
+
+		while (order < MAX_ORDER
+		       && (page_idx & ((size_t) 1 << order)) == 0
+		       && ((size_t) 2 << order) <= page_cnt)
+			order++;
+		buddy_free (pool, page_idx, order);
+		page_idx += (size_t) 1 << order;
+		page_cnt -= (size_t) 1 << order;
+	}
+}
+
+/* Prints page allocator statistics: for each pool, how much of
+   it is free and how fragmented the free memory is. */
+void
+palloc_print_stats (void) {
+	print_pool_stats ("Kernel pool", &kernel_pool);
+	print_pool_stats ("User pool", &user_pool);
+}
+
+/* Prints statistics for POOL under NAME.  Fragmentation is the
+   share of free pages that lie outside the largest free block,
+   so 0% means that every free page could go to a single
+   request. */
+static void
+print_pool_stats (const char *name, struct pool *pool) {
+	size_t blocks[MAX_ORDER + 1];
+	size_t free_cnt, cached = 0, zeroed, largest = 0;
+	long long zero_hits, zero_requests;
+	enum intr_level old_level;
+	int order, i;
+
+	old_level = intr_disable ();
+	spinlock_acquire (&pool->lock);
+	free_cnt = pool->free_cnt;
+	for (i = 0; i < cpu_cnt; i++)
+		cached += pool->mags[i].cnt;
+	zeroed = pool->zeroed_cnt;
+	zero_hits = pool->zero_hits;
+	zero_requests = pool->zero_hits + pool->zero_misses;
+	for (order = 0; order <= MAX_ORDER; order++) {
+		blocks[order] = list_size (&pool->free_lists[order]);
+		if (blocks[order] > 0)
+			largest = (size_t) 1 << order;
+	}
+	spinlock_release (&pool->lock);
+	intr_set_level (old_level);
+
+	printf ("%s: %'zu of %'zu pages free, largest free block %'zu pages, "
+	        "%zu%% fragmented\n", name, free_cnt,
+	        bitmap_size (pool->used_map), largest,
+	        free_cnt > 0 ? (free_cnt - largest) * 100 / free_cnt : 0);
+	printf ("  %'zu more pages cached in magazines, %'zu pre-zeroed\n",
+	        cached, zeroed);
+	printf ("  %'lld of %'lld PAL_ZERO pages served pre-zeroed (%lld%%)\n",
+	        zero_hits, zero_requests,
+	        zero_requests > 0 ? zero_hits * 100 / zero_requests : 0);
+	printf ("  free blocks by order:");
+	for (order = 0; order <= MAX_ORDER; order++)
+		if (blocks[order] > 0)
+			printf (" %d:%zu", order, blocks[order]);
+	printf ("\n");
+}
@@ -0,0 +1,90 @@
+#include "threads/runqueue.h"
+#include <debug.h>
+#include "threads/interrupt.h"
+
+/* One bit per priority level must fit in the bitmap. */
+#if PRI_CNT > 64
+#error runqueue bitmap holds at most 64 priority levels
+#endif
+
+/* Returns the bitmap bit for priority level PRI. */
+#define PRI_BIT(PRI) ((uint64_t) 1 << ((PRI) - PRI_MIN))
+
+/* Initializes RQ as an empty run queue. */
+void
+runqueue_init (struct runqueue *rq) {
+	int i;
+
+	ASSERT (rq != NULL);
+
+	rq->bitmap = 0;
+	rq->size = 0;
+	for (i = 0; i < PRI_CNT; i++)
+		list_init (&rq->queues[i]);
+}
+
+/* Returns true if RQ holds no threads. */
+bool
+runqueue_empty (const struct runqueue *rq) {
+	return rq->bitmap == 0;
+}
+
+/* Returns the number of threads in RQ. */
+size_t
+runqueue_size (const struct runqueue *rq) {
+	return rq->size;
+}
+
+/* Returns the priority of the highest-priority thread in RQ, or
+   PRI_MIN - 1 if RQ is empty. */
+int
+runqueue_max_priority (const struct runqueue *rq) {
+	if (rq->bitmap == 0)
+		return PRI_MIN - 1;
+	return PRI_MIN + 63 - __builtin_clzll (rq->bitmap);
+}
+
+/* Adds T at the back of the FIFO for its current priority.
+   Interrupts must be off. */
+void
+runqueue_push (struct runqueue *rq, struct thread *t) {
+	int pri = t->priority;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+	ASSERT (PRI_MIN <= pri && pri <= PRI_MAX);
+
+	t->rq_priority = pri;
+	list_push_back (&rq->queues[pri - PRI_MIN], &t->elem);
+	rq->bitmap |= PRI_BIT (pri);
+	rq->size++;
+}
+
+/* Removes T, which must be in RQ, from RQ.
+   Interrupts must be off. */
+void
+runqueue_remove (struct runqueue *rq, struct thread *t) {
+	int pri = t->rq_priority;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+	ASSERT (rq->bitmap & PRI_BIT (pri));
+
+	list_remove (&t->elem);
+	if (list_empty (&rq->queues[pri - PRI_MIN]))
+		rq->bitmap &= ~PRI_BIT (pri);
+	rq->size--;
+}
+
+/* Removes and returns the thread at the front of the
+   highest-priority nonempty FIFO in RQ, which must not be empty.
+   Interrupts must be off. */
+struct thread *
+runqueue_pop (struct runqueue *rq) {
+	struct thread *t;
+
+	ASSERT (!runqueue_empty (rq));
+
+	t = list_entry (list_front (&rq->queues[runqueue_max_priority (rq)
+				- PRI_MIN]), struct thread, elem);
+	runqueue_remove (rq, t);
+	return t;
+}
@@ -0,0 +1,234 @@
+#include "threads/sched.h"
+#include <debug.h>
+#include <rbtree.h>
+#include "threads/interrupt.h"
+#include "threads/thread.h"
+
+/* Completely fair scheduling class ("-cfs").
+
+   Each thread has a weight determined by its nice value and a
+   virtual runtime, `vruntime', that advances for every tick the
+   thread runs, more slowly the heavier the thread.  The ready
+   thread with the least vruntime runs next, so over time every
+   thread receives CPU time in proportion to its weight.  Ready
+   threads wait in a red-black tree ordered by vruntime, which
+   makes enqueueing O(lg n) and finding the next thread O(1).
+
+   There is no fixed time slice.  Instead, every ready thread
+   should get to run once per scheduling period of CFS_LATENCY
+   ticks, and a thread's slice is its weighted share of that
+   period, but no less than CFS_MIN_GRANULARITY.
+
+   A thread that sleeps stops accumulating vruntime, so when it
+   wakes up it is placed no further back than CFS_SLEEPER_CREDIT
+   behind the CPU's min_vruntime.  That small credit lets a
+   thread that blocks often, such as one waiting on a timer or
+   the disk, preempt CPU-bound threads as soon as it wakes up,
+   without letting it bank its sleep time and monopolize the CPU
+   afterward.
+
+   New threads inherit their creator's vruntime (see
+   init_thread()), so creating threads cannot be used to jump
+   the queue.  Priorities play no part: thread_set_priority()
+   only records the value, and there is no priority donation. */
+
+/* Scheduling period and minimum slice, in timer ticks. */
+#define CFS_LATENCY 8
+#define CFS_MIN_GRANULARITY 1
+
+/* Weight of a nice 0 thread. */
+#define NICE_0_WEIGHT 1024
+
+/* vruntime a nice 0 thread accumulates per tick. */
+#define VRUNTIME_PER_TICK ((int64_t) 1 << 20)
+
+/* How far behind min_vruntime a waking thread may be placed. */
+#define CFS_SLEEPER_CREDIT (CFS_LATENCY * VRUNTIME_PER_TICK / 2)
+
+/* How far ahead of the leftmost ready thread the running thread
+   may get before a wakeup preempts it. */
+#define CFS_WAKEUP_GRANULARITY VRUNTIME_PER_TICK
+
+/* Weight for each nice value from NICE_MIN to NICE_MAX.  Each
+   step in nice changes a thread's share of the CPU by about 10%
+   relative to a thread at the neighboring nice value, which
+   works out to weights about 1.25 apart. */
+static const int nice_to_weight[NICE_MAX - NICE_MIN + 1] = {
+	/* -20 */ 88761, 71755, 56483, 46273, 36291,
+	/* -15 */ 29154, 23254, 18705, 14949, 11916,
+	/* -10 */  9548,  7620,  6100,  4904,  3906,
+	/*  -5 */  3121,  2501,  1991,  1586,  1277,
+	/*   0 */  1024,   820,   655,   526,   423,
+	/*   5 */   335,   272,   215,   172,   137,
+	/*  10 */   110,    87,    70,    56,    45,
+	/*  15 */    36,    29,    23,    18,    15,
+	/*  20 */    12,
+};
+
+/* Returns T's weight. */
+static inline long
+thread_weight (const struct thread *t) {
+	ASSERT (NICE_MIN <= t->nice && t->nice <= NICE_MAX);
+	return nice_to_weight[t->nice - NICE_MIN];
+}
+
+/* Returns the thread with the least vruntime on C's run queue,
+   or a null pointer if it is empty. */
+static struct thread *
+leftmost (struct cpu *c) {
+	struct rb_elem *e = rbtree_first (&c->cfs_rq);
+
+	return e != NULL ? rb_entry (e, struct thread, rb_elem) : NULL;
+}
+
+/* Orders threads in a CPU's cfs_rq by increasing vruntime. */
+static bool
+vruntime_less (const struct rb_elem *a_, const struct rb_elem *b_,
+               void *aux UNUSED) {
+	const struct thread *a = rb_entry (a_, struct thread, rb_elem);
+	const struct thread *b = rb_entry (b_, struct thread, rb_elem);
+
+	return a->vruntime < b->vruntime;
+}
+
+/* Advances C's min_vruntime to the least vruntime among C's
+   running thread CURR, if any, and its ready threads.
+   min_vruntime never moves backward. */
+static void
+update_min_vruntime (struct cpu *c, struct thread *curr) {
+	struct thread *first = leftmost (c);
+	int64_t vruntime;
+
+	if (curr != NULL)
+		vruntime = first != NULL && first->vruntime < curr->vruntime
+			? first->vruntime : curr->vruntime;
+	else if (first != NULL)
+		vruntime = first->vruntime;
+	else
+		return;
+
+	if (vruntime > c->cfs_min_vruntime)
+		c->cfs_min_vruntime = vruntime;
+}
+
+/* Returns the number of ticks running thread T may run on C
+   before it is preempted. */
+static unsigned
+time_slice (struct cpu *c, struct thread *t) {
+	long weight = thread_weight (t);
+	long load = c->cfs_load + weight;
+	unsigned nr_running = c->nr_ready + 1;
+	unsigned period = CFS_LATENCY;
+	unsigned slice;
+
+	/* With many threads, stretch the period rather than cutting
+	   slices below the minimum. */
+	if (nr_running * CFS_MIN_GRANULARITY > period)
+		period = nr_running * CFS_MIN_GRANULARITY;
+
+	slice = period * weight / load;
+	return slice > CFS_MIN_GRANULARITY ? slice : CFS_MIN_GRANULARITY;
+}
+
+static void
+cfs_init (struct cpu *c) {
+	rbtree_init (&c->cfs_rq, vruntime_less, NULL);
+	c->cfs_min_vruntime = 0;
+	c->cfs_load = 0;
+}
+
+static void
+cfs_start (void) {
+}
+
+static void
+cfs_enqueue (struct cpu *c, struct thread *t) {
+	int64_t floor = c->cfs_min_vruntime - CFS_SLEEPER_CREDIT;
+
+	if (t->vruntime < floor)
+		t->vruntime = floor;
+	rbtree_insert (&c->cfs_rq, &t->rb_elem);
+	c->cfs_load += thread_weight (t);
+}
+
+static void
+cfs_dequeue (struct cpu *c, struct thread *t) {
+	rbtree_remove (&c->cfs_rq, &t->rb_elem);
+	c->cfs_load -= thread_weight (t);
+}
+
+static struct thread *
+cfs_pick_next (struct cpu *c) {
+	struct thread *t = leftmost (c);
+
+	if (t == NULL)
+		return NULL;
+
+	cfs_dequeue (c, t);
+	update_min_vruntime (c, t);
+	return t;
+}
+
+static bool
+cfs_tick (struct cpu *c, struct thread *t) {
+	if (t == c->idle_thread)
+		return ++c->thread_ticks >= TIME_SLICE;
+
+	t->vruntime += VRUNTIME_PER_TICK * NICE_0_WEIGHT / thread_weight (t);
+	update_min_vruntime (c, t);
+	return ++c->thread_ticks >= time_slice (c, t);
+}
+
+static bool
+cfs_yield_check (struct cpu *c, struct thread *t) {
+	struct thread *first = leftmost (c);
+
+	return first != NULL
+		&& first->vruntime + CFS_WAKEUP_GRANULARITY < t->vruntime;
+}
+
+static void
+cfs_priority_changed (struct cpu *c UNUSED, struct thread *t UNUSED) {
+}
+
+static void
+cfs_set_priority (int priority) {
+	struct thread *t = thread_current ();
+
+	t->init_priority = t->priority = priority;
+}
+
+/* The running thread is never on the run queue, so its weight
+   can change without touching cfs_load.  NICE is clamped to the
+   range nice_to_weight[] covers. */
+static void
+cfs_set_nice (int nice) {
+	if (nice < NICE_MIN)
+		nice = NICE_MIN;
+	else if (nice > NICE_MAX)
+		nice = NICE_MAX;
+	thread_current ()->nice = nice;
+}
+
+static void
+cfs_lock_wait (struct thread *t UNUSED, struct lock *lock UNUSED) {
+}
+
+static void
+cfs_lock_release (struct lock *lock UNUSED) {
+}
+
+const struct sched_class sched_cfs_class = {
+	.name = "cfs",
+	.init = cfs_init,
+	.start = cfs_start,
+	.enqueue = cfs_enqueue,
+	.pick_next = cfs_pick_next,
+	.tick = cfs_tick,
+	.yield_check = cfs_yield_check,
+	.priority_changed = cfs_priority_changed,
+	.set_priority = cfs_set_priority,
+	.set_nice = cfs_set_nice,
+	.lock_wait = cfs_lock_wait,
+	.lock_release = cfs_lock_release,
+};
@@ -0,0 +1,320 @@
+#include "threads/sched.h"
+#include <debug.h>
+#include <heap.h>
+#include <stdio.h>
+#include "threads/interrupt.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+/* Earliest-deadline-first scheduling class.
+
+   A thread joins this class by calling thread_set_deadline() with
+   a (runtime, period, deadline) triple, in timer ticks: every
+   PERIOD ticks it starts a new job that needs up to RUNTIME ticks
+   of CPU time and should be done DEADLINE ticks after the period
+   starts.  thread.c serves this class's run queue before
+   thread_sched's, so a ready EDF thread always runs ahead of
+   ordinary threads, and among EDF threads the one whose current
+   job has the earliest absolute deadline runs first.
+
+   Registration is subject to admission control: it fails if the
+   total bandwidth, the sum of runtime / period over all EDF
+   threads, would exceed EDF_BW_LIMIT per CPU, which keeps EDF
+   threads from starving everything else.
+
+   A thread that uses up its runtime before its job is done is
+   throttled: it stays THREAD_READY but is parked off the run
+   queue, and out of its CPU's nr_ready, until its next period
+   starts, when edf_replenish() gives it a fresh budget and
+   deadline.  A thread that finishes its job early calls
+   thread_wait_period() to sleep until then.  A job that is not
+   done by its deadline counts as a deadline miss.
+
+   A thread that wakes up past its deadline, after blocking on a
+   lock or the disk in the middle of a job, starts a new period on
+   the spot rather than running with a deadline already in the
+   past. */
+
+/* Fixed-point scale for bandwidths. */
+#define BW_SHIFT 20
+#define BW_ONE ((int64_t) 1 << BW_SHIFT)
+
+/* Largest total bandwidth admitted per CPU, 95%. */
+#define EDF_BW_LIMIT (BW_ONE * 95 / 100)
+
+/* Total bandwidth of all EDF threads, guarded by edf_lock. */
+static int64_t edf_total_bw;
+static struct spinlock edf_lock;
+
+static timer_func edf_replenish;
+
+/* Returns the bandwidth of RUNTIME ticks every PERIOD ticks. */
+static int64_t
+bandwidth (int64_t runtime, int64_t period) {
+	return (runtime << BW_SHIFT) / period;
+}
+
+/* Orders threads in a CPU's edf_rq by increasing deadline. */
+static bool
+deadline_less (const struct heap_elem *a_, const struct heap_elem *b_,
+               void *aux UNUSED) {
+	const struct thread *a = heap_entry (a_, struct thread, heap_elem);
+	const struct thread *b = heap_entry (b_, struct thread, heap_elem);
+
+	return a->dl_abs_deadline < b->dl_abs_deadline;
+}
+
+/* Starts a new job for T, with a period beginning at NOW. */
+static void
+start_period (struct thread *t, int64_t now) {
+	t->dl_abs_deadline = now + t->dl_deadline;
+	t->dl_budget = t->dl_runtime;
+	t->dl_missed = false;
+	t->cpu->dl_jobs++;
+}
+
+/* Counts T's current job as having missed its deadline, unless
+   it was already counted. */
+static void
+mark_missed (struct thread *t) {
+	if (!t->dl_missed) {
+		t->dl_missed = true;
+		t->cpu->dl_misses++;
+	}
+}
+
+/* Returns the tick at which T's next period starts. */
+static int64_t
+next_period (const struct thread *t) {
+	return t->dl_abs_deadline - t->dl_deadline + t->dl_period;
+}
+
+/* Makes the running thread an EDF thread that needs RUNTIME ticks
+   of CPU time every PERIOD ticks, finishing within DEADLINE ticks
+   of the start of each period, with 0 < RUNTIME <= DEADLINE <=
+   PERIOD.  Its first period starts now.  Calling this again
+   replaces the thread's parameters.
+
+   Returns false, leaving the thread as it was, if the parameters
+   are out of range or admitting the thread would push the total
+   bandwidth of EDF threads past the limit.
+
+   If all three arguments are 0, the thread leaves the EDF class
+   and goes back to being scheduled like any other thread.  This
+   always succeeds. */
+bool
+thread_set_deadline (int64_t runtime, int64_t period, int64_t deadline) {
+	struct thread *t = thread_current ();
+	bool leave = runtime == 0 && period == 0 && deadline == 0;
+	int64_t old_bw, new_bw;
+	enum intr_level old_level;
+
+	if (!leave && (runtime <= 0 || runtime > deadline || deadline > period))
+		return false;
+
+	old_level = intr_disable ();
+	old_bw = t->sched == &sched_edf_class
+		? bandwidth (t->dl_runtime, t->dl_period) : 0;
+	new_bw = leave ? 0 : bandwidth (runtime, period);
+
+	spinlock_acquire (&edf_lock);
+	if (edf_total_bw - old_bw + new_bw > cpu_cnt * EDF_BW_LIMIT) {
+		spinlock_release (&edf_lock);
+		intr_set_level (old_level);
+		return false;
+	}
+	edf_total_bw += new_bw - old_bw;
+	spinlock_release (&edf_lock);
+
+	if (leave)
+		t->sched = thread_sched;
+	else {
+		t->dl_runtime = runtime;
+		t->dl_period = period;
+		t->dl_deadline = deadline;
+		t->dl_throttled = false;
+		timer_event_init (&t->dl_timer, edf_replenish, t);
+		start_period (t, timer_ticks ());
+		t->sched = &sched_edf_class;
+	}
+	intr_set_level (old_level);
+
+	preempt_priority ();
+	return true;
+}
+
+/* Tells the scheduler that the running EDF thread has finished
+   its current job, and sleeps until its next period starts. */
+void
+thread_wait_period (void) {
+	struct thread *t = thread_current ();
+	enum intr_level old_level;
+	int64_t now;
+
+	ASSERT (t->sched == &sched_edf_class);
+
+	old_level = intr_disable ();
+	now = timer_ticks ();
+	if (now > t->dl_abs_deadline)
+		mark_missed (t);
+
+	if (next_period (t) > now) {
+		t->dl_throttled = true;
+		timer_arm (&t->dl_timer, next_period (t));
+		thread_block ();
+	} else
+		start_period (t, now);
+	intr_set_level (old_level);
+}
+
+/* Timer callback that starts throttled thread T_'s next period
+   and makes it runnable again. */
+static void
+edf_replenish (void *t_) {
+	struct thread *t = t_;
+
+	ASSERT (t->dl_throttled);
+
+	/* A thread that is still ready, rather than blocked in
+	   thread_wait_period(), ran out of budget mid-job. */
+	if (t->status == THREAD_READY)
+		mark_missed (t);
+
+	t->dl_throttled = false;
+	start_period (t, timer_ticks ());
+
+	if (t->status == THREAD_BLOCKED)
+		thread_unblock (t);
+	else {
+		struct cpu *c = t->cpu;
+
+		spinlock_acquire (&c->rq_lock);
+		heap_insert (&c->edf_rq, &t->heap_elem);
+		c->nr_ready++;
+		spinlock_release (&c->rq_lock);
+	}
+	preempt_priority ();
+}
+
+/* Prints EDF statistics, if any thread has used the class. */
+void
+edf_print_stats (void) {
+	long long jobs = 0, misses = 0, throttles = 0;
+	int i;
+
+	for (i = 0; i < cpu_cnt; i++) {
+		jobs += cpus[i].dl_jobs;
+		misses += cpus[i].dl_misses;
+		throttles += cpus[i].dl_throttles;
+	}
+	if (jobs > 0)
+		printf ("EDF: %lld jobs, %lld deadline misses, %lld throttles\n",
+		        jobs, misses, throttles);
+}
+
+static void
+edf_init (struct cpu *c) {
+	heap_init (&c->edf_rq, deadline_less, NULL);
+	if (c->id == 0)
+		spinlock_init (&edf_lock);
+}
+
+static void
+edf_start (void) {
+}
+
+static void
+edf_enqueue (struct cpu *c, struct thread *t) {
+	int64_t now = timer_ticks ();
+
+	/* Parked until edf_replenish(), and not runnable until then,
+	   so not counted as ready either. */
+	if (t->dl_throttled) {
+		c->nr_ready--;
+		return;
+	}
+
+	if (now > t->dl_abs_deadline) {
+		mark_missed (t);
+		start_period (t, now);
+	}
+	heap_insert (&c->edf_rq, &t->heap_elem);
+}
+
+static struct thread *
+edf_pick_next (struct cpu *c) {
+	if (heap_empty (&c->edf_rq))
+		return NULL;
+	return heap_entry (heap_pop_min (&c->edf_rq), struct thread, heap_elem);
+}
+
+static bool
+edf_tick (struct cpu *c, struct thread *t) {
+	int64_t now = timer_ticks ();
+
+	if (now > t->dl_abs_deadline)
+		mark_missed (t);
+	if (--t->dl_budget > 0)
+		return false;
+
+	t->dl_throttled = true;
+	c->dl_throttles++;
+	timer_arm (&t->dl_timer,
+	           next_period (t) > now ? next_period (t) : now + 1);
+	return true;
+}
+
+/* Any ready EDF thread preempts an ordinary thread; an EDF thread
+   yields only to an earlier deadline. */
+static bool
+edf_yield_check (struct cpu *c, struct thread *t) {
+	struct heap_elem *e = heap_min (&c->edf_rq);
+
+	if (e == NULL)
+		return false;
+	if (t->sched != &sched_edf_class)
+		return true;
+	return heap_entry (e, struct thread, heap_elem)->dl_abs_deadline
+		< t->dl_abs_deadline;
+}
+
+static void
+edf_priority_changed (struct cpu *c UNUSED, struct thread *t UNUSED) {
+}
+
+/* thread.c routes the remaining hooks to thread_sched even for
+   EDF threads. */
+static void
+edf_set_priority (int priority UNUSED) {
+	NOT_REACHED ();
+}
+
+static void
+edf_set_nice (int nice UNUSED) {
+	NOT_REACHED ();
+}
+
+static void
+edf_lock_wait (struct thread *t UNUSED, struct lock *lock UNUSED) {
+	NOT_REACHED ();
+}
+
+static void
+edf_lock_release (struct lock *lock UNUSED) {
+	NOT_REACHED ();
+}
+
+const struct sched_class sched_edf_class = {
+	.name = "edf",
+	.init = edf_init,
+	.start = edf_start,
+	.enqueue = edf_enqueue,
+	.pick_next = edf_pick_next,
+	.tick = edf_tick,
+	.yield_check = edf_yield_check,
+	.priority_changed = edf_priority_changed,
+	.set_priority = edf_set_priority,
+	.set_nice = edf_set_nice,
+	.lock_wait = edf_lock_wait,
+	.lock_release = edf_lock_release,
+};
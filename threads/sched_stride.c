@@ -0,0 +1,119 @@
+#include "threads/sched.h"
+#include <debug.h>
+#include <heap.h>
+#include "threads/interrupt.h"
+#include "threads/thread.h"
+
+/* Stride scheduling class ("-stride").
+
+   Each thread holds a number of tickets and receives CPU time in
+   proportion to them.  A thread's `pass' is a virtual clock that
+   advances by its stride, STRIDE1 / tickets, for every tick it
+   runs, so a thread with twice the tickets has a pass that
+   advances half as fast.  The ready thread with the lowest pass
+   runs next.
+
+   A thread that blocks stops advancing its pass.  So that it
+   cannot bank that time and monopolize the CPU when it wakes
+   up, its pass is raised on wakeup to the CPU's virtual time,
+   the pass of the thread most recently picked to run.
+
+   Priorities play no part: thread_set_priority() only records
+   the value, and there is no priority donation. */
+
+/* Fixed-point scale of a stride.  Large enough that the stride
+   of a thread with TICKETS_MAX tickets keeps some precision. */
+#define STRIDE1 (1 << 20)
+
+/* Orders threads in a CPU's stride_rq by increasing pass. */
+static bool
+pass_less (const struct heap_elem *a_, const struct heap_elem *b_,
+           void *aux UNUSED) {
+	const struct thread *a = heap_entry (a_, struct thread, heap_elem);
+	const struct thread *b = heap_entry (b_, struct thread, heap_elem);
+
+	return a->pass < b->pass;
+}
+
+static void
+stride_init (struct cpu *c) {
+	heap_init (&c->stride_rq, pass_less, NULL);
+	c->stride_vtime = 0;
+}
+
+static void
+stride_start (void) {
+}
+
+static void
+stride_enqueue (struct cpu *c, struct thread *t) {
+	if (t->pass < c->stride_vtime)
+		t->pass = c->stride_vtime;
+	heap_insert (&c->stride_rq, &t->heap_elem);
+}
+
+static struct thread *
+stride_pick_next (struct cpu *c) {
+	struct thread *t;
+
+	if (heap_empty (&c->stride_rq))
+		return NULL;
+
+	t = heap_entry (heap_pop_min (&c->stride_rq), struct thread, heap_elem);
+	c->stride_vtime = t->pass;
+	return t;
+}
+
+static bool
+stride_tick (struct cpu *c, struct thread *t) {
+	if (t != c->idle_thread)
+		t->pass += STRIDE1 / t->tickets;
+	return ++c->thread_ticks >= TIME_SLICE;
+}
+
+static bool
+stride_yield_check (struct cpu *c, struct thread *t) {
+	struct heap_elem *min = heap_min (&c->stride_rq);
+
+	return min != NULL
+		&& heap_entry (min, struct thread, heap_elem)->pass < t->pass;
+}
+
+static void
+stride_priority_changed (struct cpu *c UNUSED, struct thread *t UNUSED) {
+}
+
+static void
+stride_set_priority (int priority) {
+	struct thread *t = thread_current ();
+
+	t->init_priority = t->priority = priority;
+}
+
+static void
+stride_set_nice (int nice) {
+	thread_current ()->nice = nice;
+}
+
+static void
+stride_lock_wait (struct thread *t UNUSED, struct lock *lock UNUSED) {
+}
+
+static void
+stride_lock_release (struct lock *lock UNUSED) {
+}
+
+const struct sched_class sched_stride_class = {
+	.name = "stride",
+	.init = stride_init,
+	.start = stride_start,
+	.enqueue = stride_enqueue,
+	.pick_next = stride_pick_next,
+	.tick = stride_tick,
+	.yield_check = stride_yield_check,
+	.priority_changed = stride_priority_changed,
+	.set_priority = stride_set_priority,
+	.set_nice = stride_set_nice,
+	.lock_wait = stride_lock_wait,
+	.lock_release = stride_lock_release,
+};
@@ -0,0 +1,346 @@
+#include "threads/slab.h"
+#include <debug.h>
+#include <list.h>
+#include <round.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/lockstat.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
+
+/* Slab allocator.
+
+   malloc() rounds each request up to a power of 2, which wastes
+   up to half of each block on fixed-size objects such as inodes
+   and open files, and serializes all requests of a size on one
+   descriptor.  A "cache" created by kmem_cache_create() instead
+   serves objects of exactly one size, packed as tightly as their
+   alignment allows, under a lock of its own.
+
+   A cache gets its memory one page, called a "slab", at a time.
+   The slab starts with a header and a stack of the indexes of
+   its free objects, followed by the objects.  Keeping the free
+   stack outside the objects means that a free object keeps its
+   contents, so a constructor passed to kmem_cache_create() only
+   has to run when a slab is created, not on every allocation.
+
+   Each cache keeps its slabs on three lists: "partial" slabs
+   have both free and allocated objects, "full" slabs have no
+   free objects, and "empty" slabs have no allocated objects.
+   Allocations are made from a partial slab if there is one, and
+   then from an empty one, before a new slab is created.  One
+   empty slab is kept to absorb alloc/free cycles; any more are
+   given back to the page allocator as they empty out.
+
+   An object has to fit in a single slab together with the slab
+   header.  Use malloc() or palloc for anything larger. */
+
+/* Magic number for detecting slab corruption. */
+#define SLAB_MAGIC 0x51ab51ab
+
+/* A slab. */
+struct slab {
+	unsigned magic;             /* Always set to SLAB_MAGIC. */
+	struct kmem_cache *cache;   /* Owning cache. */
+	struct list_elem elem;      /* Element in one of the cache's lists. */
+	size_t free_cnt;            /* Number of free objects. */
+	uint16_t free[];            /* Indexes of the free objects. */
+};
+
+/* An object cache. */
+struct kmem_cache {
+	char name[16];              /* Name, for statistics. */
+	size_t obj_size;            /* Size of an object in bytes. */
+	size_t stride;              /* Bytes from one object to the next. */
+	size_t obj_ofs;             /* Offset of first object in a slab. */
+	size_t objs_per_slab;       /* Number of objects in a slab. */
+	kmem_ctor_func *ctor;       /* Constructor, or null. */
+	struct list_elem elem;      /* Element in all_caches. */
+
+	struct lock lock;           /* Protects the members below. */
+	struct list partial;        /* Slabs with free and used objects. */
+	struct list full;           /* Slabs with no free objects. */
+	struct list empty;          /* Slabs with no used objects. */
+
+	/* Statistics. */
+	size_t slab_cnt;            /* Number of slabs. */
+	size_t in_use;              /* Number of objects allocated. */
+	size_t peak_in_use;         /* Largest value of in_use. */
+	long long allocs;           /* Number of allocations. */
+	long long frees;            /* Number of frees. */
+};
+
+/* All the caches, for kmem_print_stats(). */
+static struct list all_caches;
+static struct lock all_caches_lock;
+
+static struct slab *new_slab (struct kmem_cache *);
+static void *slab_obj (struct kmem_cache *, struct slab *, size_t idx);
+static struct slab *obj_to_slab (struct kmem_cache *, void *obj);
+
+/* Initializes the slab allocator. */
+void
+kmem_init (void) {
+	list_init (&all_caches);
+	lock_init (&all_caches_lock);
+}
+
+/* Creates and returns a cache of objects of SIZE bytes, aligned
+   on ALIGN bytes, which must be a power of 2, or 0 for pointer
+   alignment.  If CTOR is nonnull, each object is passed to it
+   when its slab is created.  NAME identifies the cache in the
+   statistics.  Returns a null pointer if memory is not
+   available. */
+struct kmem_cache *
+kmem_cache_create (const char *name, size_t size, size_t align,
+                   kmem_ctor_func *ctor) {
+	struct kmem_cache *c;
+	size_t cnt;
+
+	if (align == 0)
+		align = sizeof (void *);
+	ASSERT (size > 0);
+	ASSERT ((align & (align - 1)) == 0);
+
+	c = malloc (sizeof *c);
+	if (c == NULL)
+		return NULL;
+
+	strlcpy (c->name, name, sizeof c->name);
+	c->obj_size = size;
+	c->stride = ROUND_UP (size, align);
+	c->ctor = ctor;
+
+	/* Fit as many objects as the header, its free stack, and the
+	   alignment of the first object leave room for. */
+	cnt = (PGSIZE - sizeof (struct slab)) / (c->stride + sizeof (uint16_t));
+	while (cnt > 0
+	       && ROUND_UP (sizeof (struct slab) + cnt * sizeof (uint16_t), align)
+	          + cnt * c->stride > PGSIZE)
+		cnt--;
+	ASSERT (cnt > 0);
+	c->objs_per_slab = cnt;
+	c->obj_ofs = ROUND_UP (sizeof (struct slab) + cnt * sizeof (uint16_t),
+	                       align);
+
+	lock_init_named (&c->lock, c->name);
+	list_init (&c->partial);
+	list_init (&c->full);
+	list_init (&c->empty);
+	c->slab_cnt = c->in_use = c->peak_in_use = 0;
+	c->allocs = c->frees = 0;
+
+	lock_acquire (&all_caches_lock);
+	list_push_back (&all_caches, &c->elem);
+	lock_release (&all_caches_lock);
+	return c;
+}
+
+/* Destroys cache C, which must have no objects allocated. */
+void
+kmem_cache_destroy (struct kmem_cache *c) {
+	if (c == NULL)
+		return;
+
+	ASSERT (c->in_use == 0);
+	kmem_cache_shrink (c);
+	ASSERT (c->slab_cnt == 0);
+
+	lock_acquire (&all_caches_lock);
+	list_remove (&c->elem);
+	lock_release (&all_caches_lock);
+	lockstat_unregister (c->lock.stats);
+	free (c);
+}
+
+/* Allocates and returns an object from cache C.
+   Returns a null pointer if memory is not available. */
+void *
+kmem_cache_alloc (struct kmem_cache *c) {
+	struct slab *s;
+	void *obj;
+
+	lock_acquire (&c->lock);
+
+	/* Find a slab with a free object. */
+	if (!list_empty (&c->partial))
+		s = list_entry (list_front (&c->partial), struct slab, elem);
+	else if (!list_empty (&c->empty)) {
+		s = list_entry (list_pop_front (&c->empty), struct slab, elem);
+		list_push_front (&c->partial, &s->elem);
+	} else {
+		s = new_slab (c);
+		if (s == NULL) {
+			lock_release (&c->lock);
+			return NULL;
+		}
+		list_push_front (&c->partial, &s->elem);
+	}
+
+	/* Take an object from it. */
+	obj = slab_obj (c, s, s->free[--s->free_cnt]);
+	if (s->free_cnt == 0) {
+		list_remove (&s->elem);
+		list_push_front (&c->full, &s->elem);
+	}
+
+	c->allocs++;
+	if (++c->in_use > c->peak_in_use)
+		c->peak_in_use = c->in_use;
+	lock_release (&c->lock);
+	return obj;
+}
+
+/* Returns OBJ, which must have been allocated from cache C, to
+   C.  If C has a constructor, OBJ must be in its constructed
+   state. */
+void
+kmem_cache_free (struct kmem_cache *c, void *obj) {
+	struct slab *s;
+	void *page = NULL;
+
+	if (obj == NULL)
+		return;
+
+	s = obj_to_slab (c, obj);
+
+#ifndef NDEBUG
+	/* Clear the object to help detect use-after-free bugs, unless
+	   its contents have to survive for the constructor's sake. */
+	if (c->ctor == NULL)
+		memset (obj, 0xcc, c->obj_size);
+#endif
+
+	lock_acquire (&c->lock);
+	ASSERT (s->free_cnt < c->objs_per_slab);
+	s->free[s->free_cnt++] = ((uint8_t *) obj - ((uint8_t *) s + c->obj_ofs))
+	                         / c->stride;
+
+	if (s->free_cnt == c->objs_per_slab) {
+		/* Now empty.  Keep one empty slab around. */
+		list_remove (&s->elem);
+		if (list_empty (&c->empty))
+			list_push_front (&c->empty, &s->elem);
+		else {
+			c->slab_cnt--;
+			page = s;
+		}
+	} else if (s->free_cnt == 1) {
+		/* Was full. */
+		list_remove (&s->elem);
+		list_push_front (&c->partial, &s->elem);
+	}
+
+	c->frees++;
+	c->in_use--;
+	lock_release (&c->lock);
+
+	if (page != NULL) {
+		s->magic = 0;
+		palloc_free_page (page);
+	}
+}
+
+/* Gives cache C's empty slabs back to the page allocator and
+   returns the number of pages freed. */
+size_t
+kmem_cache_shrink (struct kmem_cache *c) {
+	struct list victims;
+	size_t cnt = 0;
+
+	list_init (&victims);
+	lock_acquire (&c->lock);
+	while (!list_empty (&c->empty)) {
+		list_push_back (&victims, list_pop_front (&c->empty));
+		c->slab_cnt--;
+	}
+	lock_release (&c->lock);
+
+	while (!list_empty (&victims)) {
+		struct slab *s = list_entry (list_pop_front (&victims), struct slab, elem);
+		s->magic = 0;
+		palloc_free_page (s);
+		cnt++;
+	}
+	return cnt;
+}
+
+/* Prints statistics for each cache that has been used. */
+void
+kmem_print_stats (void) {
+	struct list_elem *e;
+	bool header = false;
+
+	lock_acquire (&all_caches_lock);
+	for (e = list_begin (&all_caches); e != list_end (&all_caches);
+	     e = list_next (e)) {
+		struct kmem_cache *c = list_entry (e, struct kmem_cache, elem);
+
+		if (c->allocs == 0)
+			continue;
+		if (!header) {
+			printf ("Slab caches:\n");
+			printf ("%-16s %6s %6s %8s %8s %6s %10s\n", "name", "size",
+			        "/slab", "in use", "peak", "slabs", "allocs");
+			header = true;
+		}
+		printf ("%-16s %6zu %6zu %8zu %8zu %6zu %10lld\n",
+		        c->name, c->obj_size, c->objs_per_slab, c->in_use,
+		        c->peak_in_use, c->slab_cnt, c->allocs);
+	}
+	lock_release (&all_caches_lock);
+}
+
+/* Allocates a new slab for cache C, constructs its objects, and
+   returns it, or returns a null pointer if memory is not
+   available.  C's lock must be held. */
+static struct slab *
+new_slab (struct kmem_cache *c) {
+	struct slab *s;
+	size_t i;
+
+	s = palloc_get_page (0);
+	if (s == NULL)
+		return NULL;
+
+	s->magic = SLAB_MAGIC;
+	s->cache = c;
+	s->free_cnt = c->objs_per_slab;
+
+	/* Stack the objects so that the first one is handed out first. */
+	for (i = 0; i < c->objs_per_slab; i++) {
+		s->free[c->objs_per_slab - 1 - i] = i;
+		if (c->ctor != NULL)
+			c->ctor (slab_obj (c, s, i));
+	}
+
+	c->slab_cnt++;
+	return s;
+}
+
+/* Returns object IDX in slab S of cache C. */
+static void *
+slab_obj (struct kmem_cache *c, struct slab *s, size_t idx) {
+	return (uint8_t *) s + c->obj_ofs + idx * c->stride;
+}
+
+/* Returns the slab that OBJ, from cache C, is inside. */
+static struct slab *
+obj_to_slab (struct kmem_cache *c, void *obj) {
+	struct slab *s = pg_round_down (obj);
+
+	/* Check that the slab is valid and belongs to C. */
+	ASSERT (s != NULL);
+	ASSERT (s->magic == SLAB_MAGIC);
+	ASSERT (s->cache == c);
+
+	/* Check that the object is properly aligned for the slab. */
+	ASSERT (pg_ofs (obj) >= c->obj_ofs);
+	ASSERT ((pg_ofs (obj) - c->obj_ofs) % c->stride == 0);
+
+	return s;
+}
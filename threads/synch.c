@@ -30,9 +30,13 @@
 #include <stdio.h>
 #include <string.h>
 #include "threads/interrupt.h"
+#include "threads/lockstat.h"
 #include "threads/thread.h"
-
-bool cmp_sema_priority(const struct list_elem *a, const struct list_elem *b, void *aux UNUSED);
+#include "threads/cpu.h"
+#include "threads/sched.h"
+#include "threads/trace.h"
+#include "threads/waitq.h"
+#include "devices/timer.h"
 
 /* Initializes semaphore SEMA to VALUE.  A semaphore is a
 	 nonnegative integer along with two atomic operators for
@@ -48,7 +52,7 @@ void sema_init(struct semaphore *sema, unsigned value)
 	ASSERT(sema != NULL);
 
 	sema->value = value;
-	list_init(&sema->waiters);
+	waitq_init(&sema->waiters);
 }
 
 /* Down or "P" operation on a semaphore.  Waits for SEMA's value
@@ -69,8 +73,7 @@ void sema_down(struct semaphore *sema)
 	old_level = intr_disable();
 	while (sema->value == 0) // 세마포어 값이 0일경우, 세마포어 값이 양수가 될 때 까지 대기
 	{
-		// list_push_back (&sema->waiters, &thread_current ()->elem);
-		list_insert_ordered(&sema->waiters, &thread_current()->elem, cmp_priority, NULL);
+		waitq_push(&sema->waiters, thread_current()); // 우선순위 순서로 대기
 		thread_block(); // 스레드는 대기상태로
 	}
 	sema->value--; // 값이 양수가 되면, 1 감소
@@ -102,6 +105,69 @@ bool sema_try_down(struct semaphore *sema)
 	return success;
 }
 
+/* A thread waiting in sema_down_timeout(). */
+struct sema_timeout
+{
+	struct thread *thread; /* Waiting thread. */
+	bool timed_out;				 /* Set once the timeout has expired. */
+};
+
+/* Timer callback for sema_down_timeout(): if the waiter is still
+	 blocked on the semaphore, takes it off the wait list and wakes
+	 it up.  If sema_up() already woke it, it is no longer blocked
+	 and only the flag is set. */
+static void
+sema_timeout_expired(void *waiter_)
+{
+	struct sema_timeout *waiter = waiter_;
+
+	waiter->timed_out = true;
+	if (waiter->thread->waitq != NULL)
+	{
+		waitq_remove(waiter->thread);
+		thread_unblock(waiter->thread);
+		preempt_priority();
+	}
+}
+
+/* Down or "P" operation on a semaphore that gives up after
+	 TIMEOUT timer ticks.  Returns true if the semaphore was
+	 decremented, false if the timeout expired first.  A TIMEOUT of
+	 zero or less just tries once, like sema_try_down().
+
+	 This function may sleep, so it must not be called within an
+	 interrupt handler. */
+bool sema_down_timeout(struct semaphore *sema, int64_t timeout)
+{
+	struct sema_timeout waiter = {thread_current(), false};
+	struct timer_event event;
+	enum intr_level old_level;
+	bool success;
+
+	ASSERT(sema != NULL);
+	ASSERT(!intr_context());
+
+	old_level = intr_disable();
+	if (sema->value == 0 && timeout > 0)
+	{
+		timer_event_init(&event, sema_timeout_expired, &waiter);
+		timer_arm(&event, timer_ticks() + timeout);
+		while (sema->value == 0 && !waiter.timed_out)
+		{
+			waitq_push(&sema->waiters, thread_current());
+			thread_block();
+		}
+		timer_cancel(&event);
+	}
+
+	success = sema->value > 0;
+	if (success)
+		sema->value--;
+	intr_set_level(old_level);
+
+	return success;
+}
+
 /* Up or "V" operation on a semaphore.  Increments SEMA's value
 	 and wakes up one thread of those waiting for SEMA, if any.
 
@@ -113,13 +179,9 @@ void sema_up(struct semaphore *sema)
 	ASSERT(sema != NULL);
 
 	old_level = intr_disable();
-	if (!list_empty(&sema->waiters))
-	{
-		// waiters에 들어있는 스레드가 donate를 받아 우선순위가 달라졌을 수도 있으므로 정렬을 다시한다.
-		list_sort(&sema->waiters, cmp_priority, NULL);
-		thread_unblock(list_entry(list_pop_front(&sema->waiters),
-															struct thread, elem));
-	}
+	// 기부로 바뀐 우선순위는 대기 큐에 이미 반영되어 있으므로 정렬 없이 꺼낸다
+	if (!waitq_empty(&sema->waiters))
+		thread_unblock(waitq_pop(&sema->waiters));
 	sema->value++;
 	preempt_priority();
 	intr_set_level(old_level);
@@ -182,6 +244,23 @@ void lock_init(struct lock *lock)
 
 	lock->holder = NULL;
 	sema_init(&lock->semaphore, 1);
+	lock->stats = NULL;
+}
+
+/* Initializes LOCK like lock_init(), and registers it under NAME
+	 for contention profiling.  See lockstat.h. */
+void lock_init_named(struct lock *lock, const char *name)
+{
+	lock_init(lock);
+	lock->stats = lockstat_register(name);
+}
+
+/* Returns true if LOCK's acquisitions and releases should be
+	 recorded. */
+static bool
+lock_profiled(const struct lock *lock)
+{
+	return lock->stats != NULL && lockstat_enabled;
 }
 
 /* Acquires LOCK, sleeping until it becomes available if
@@ -194,28 +273,25 @@ void lock_init(struct lock *lock)
 	 we need to sleep. */
 void lock_acquire(struct lock *lock)
 {
-	if (thread_mlfqs)
-	{
-		sema_down(&lock->semaphore);
-		lock->holder = thread_current();
-		return;
-	}
 	ASSERT(lock != NULL);
 	ASSERT(!intr_context());
 	ASSERT(!lock_held_by_current_thread(lock));
 	struct thread *curr = thread_current();
+	int64_t wait_start = -1;
 
 	if (lock->holder != NULL) // 이미 점유중인 락이라면
 	{
-		curr->wait_on_lock = lock; // 현재 스레드의 wait_on_lock으로 지정
-		// 우선순위 지켜서 donations에 삽입
-		list_insert_ordered(&lock->holder->donations, &curr->donation_elem, cmp_d_priority, NULL);
-		donate_priority(); // 현재 스레드의 priority를 비교하여 lock holder에게 상속
+		if (lock_profiled(lock))
+			wait_start = lockstat_now(); // 기다리기 시작한 시각
+		curr->wait_on_lock = lock;			// 현재 스레드의 wait_on_lock으로 지정
+		thread_sched->lock_wait(curr, lock); // 스케줄러 정책에 따라 holder에게 우선순위 기부
 	}
 
 	sema_down(&lock->semaphore); // lock 점유
 	curr->wait_on_lock = NULL;	 // lock을 점유했으니까 wait_on_lock에서 제거
 	lock->holder = thread_current();
+	if (lock_profiled(lock))
+		lockstat_acquired(lock->stats, wait_start, __builtin_return_address(0), true);
 }
 
 // donaiton_elem 정렬
@@ -227,20 +303,22 @@ bool cmp_d_priority(const struct list_elem *a,
 	return st_a->priority > st_b->priority;
 }
 
-// 현재 스레드가 원하는 락을 가진 holder에게 현재 스레드의 우선순위 상속
-void donate_priority(void)
+// 스레드 T가 원하는 락을 가진 holder에게 T의 우선순위 상속
+void donate_priority(struct thread *t)
 {
-	struct thread *curr = thread_current();
+	struct thread *curr = t;
 	struct thread *holder;
 
 	int priority = curr->priority;
 
-	while (curr->wait_on_lock != NULL)
+	// 방금 풀린 락을 아직 기다리는 것으로 남은 스레드에서 체인이 끊긴다
+	while (curr->wait_on_lock != NULL && curr->wait_on_lock->holder != NULL)
 	{
 		holder = curr->wait_on_lock->holder;
 		if (holder->priority < priority) // 홀더의 우선순위가 작을때만 상속
 		{
-			holder->priority = priority;
+			trace_record(TRACE_DONATE, holder->tid, priority, t->tid);
+			thread_update_priority(holder, priority); // ready 상태라면 run queue 레벨도 옮긴다
 		}
 		curr = holder;
 	}
@@ -261,7 +339,11 @@ bool lock_try_acquire(struct lock *lock)
 
 	success = sema_try_down(&lock->semaphore);
 	if (success)
+	{
 		lock->holder = thread_current();
+		if (lock_profiled(lock))
+			lockstat_acquired(lock->stats, -1, __builtin_return_address(0), true);
+	}
 	return success;
 }
 
@@ -273,17 +355,12 @@ bool lock_try_acquire(struct lock *lock)
 	 handler. */
 void lock_release(struct lock *lock)
 {
-	if (thread_mlfqs)
-	{
-		lock->holder = NULL;
-		sema_up(&lock->semaphore);
-		return;
-	}
 	ASSERT(lock != NULL);
 	ASSERT(lock_held_by_current_thread(lock));
 
-	remove_donor(lock);									// 기부를 해준 donations에서 lock을 요청했던 스레드를 찾아서 제거
-	update_priority_before_donations(); // 제거하고 남은 donations에서 가장 높은 우선순위로 재조정
+	thread_sched->lock_release(lock); // 기부받은 우선순위 철회
+	if (lock_profiled(lock))
+		lockstat_released(lock->stats);
 
 	lock->holder = NULL;
 	sema_up(&lock->semaphore);
@@ -324,13 +401,13 @@ void update_priority_before_donations(void)
 
 	if (list_empty(donations)) // donors가 없으면 (donor가 하나였던 경우)
 	{
-		curr->priority = curr->init_priority; // 최초의 priority로 변경
+		thread_update_priority(curr, curr->init_priority); // 최초의 priority로 변경
 		return;
 	}
 
 	// 남은 donations중 가장 앞에있는(우선순위가 높은) donation으로 우선순위 조정
 	donations_root = list_entry(list_front(donations), struct thread, donation_elem);
-	curr->priority = donations_root->priority;
+	thread_update_priority(curr, donations_root->priority);
 }
 
 /* Returns true if the current thread holds LOCK, false
@@ -343,12 +420,309 @@ bool lock_held_by_current_thread(const struct lock *lock)
 	return lock->holder == thread_current();
 }
 
-/* One semaphore in a list. */
-struct semaphore_elem
+/* Initializes spinlock LOCK as unheld. */
+void spinlock_init(struct spinlock *lock)
 {
-	struct list_elem elem;			/* List element. */
-	struct semaphore semaphore; /* This semaphore. */
-};
+	ASSERT(lock != NULL);
+
+	lock->locked = 0;
+	lock->cpu = NULL;
+	lock->stats = NULL;
+}
+
+/* Initializes LOCK like spinlock_init(), and registers it under
+	 NAME for contention profiling.  A contended acquisition's wait
+	 is the time spent spinning.  See lockstat.h. */
+void spinlock_init_named(struct spinlock *lock, const char *name)
+{
+	spinlock_init(lock);
+	lock->stats = lockstat_register(name);
+}
+
+/* Returns true if spinlock LOCK's acquisitions and releases
+	 should be recorded. */
+static bool
+spinlock_profiled(const struct spinlock *lock)
+{
+	return lock->stats != NULL && lockstat_enabled;
+}
+
+/* Acquires LOCK, spinning until another CPU releases it.
+	 Interrupts must be off, so that the holder cannot be
+	 preempted on its own CPU while other CPUs spin.  Spinlocks
+	 are not recursive. */
+void spinlock_acquire(struct spinlock *lock)
+{
+	int64_t wait_start = -1;
+
+	ASSERT(lock != NULL);
+	ASSERT(intr_get_level() == INTR_OFF);
+	ASSERT(!spinlock_held_by_current_cpu(lock));
+
+	if (__atomic_exchange_n(&lock->locked, 1, __ATOMIC_ACQUIRE))
+	{
+		if (spinlock_profiled(lock))
+			wait_start = lockstat_now(); // 돌기 시작한 시각
+		do
+			while (lock->locked)
+				asm volatile("pause" : : : "memory");
+		while (__atomic_exchange_n(&lock->locked, 1, __ATOMIC_ACQUIRE));
+	}
+	lock->cpu = this_cpu();
+	if (spinlock_profiled(lock))
+		lockstat_acquired(lock->stats, wait_start, __builtin_return_address(0), true);
+}
+
+/* Releases LOCK, which must be held by the current CPU. */
+void spinlock_release(struct spinlock *lock)
+{
+	ASSERT(lock != NULL);
+	ASSERT(spinlock_held_by_current_cpu(lock));
+
+	if (spinlock_profiled(lock))
+		lockstat_released(lock->stats);
+	lock->cpu = NULL;
+	__atomic_store_n(&lock->locked, 0, __ATOMIC_RELEASE);
+}
+
+/* Returns true if the current CPU holds LOCK. */
+bool spinlock_held_by_current_cpu(const struct spinlock *lock)
+{
+	ASSERT(lock != NULL);
+
+	return lock->locked && lock->cpu == this_cpu();
+}
+
+/* Initializes RW as a readers-writer lock held by nobody. */
+void rwlock_init(struct rwlock *rw)
+{
+	ASSERT(rw != NULL);
+
+	lock_init(&rw->lock);
+	rw->readers = 0;
+	list_init(&rw->read_waiters);
+	list_init(&rw->write_waiters);
+}
+
+/* Initializes RW like rwlock_init(), and registers it under NAME
+	 for contention profiling. */
+void rwlock_init_named(struct rwlock *rw, const char *name)
+{
+	rwlock_init(rw);
+	rw->lock.stats = lockstat_register(name);
+}
+
+/* Blocks the running thread, which is on one of RW's wait lists,
+	 until a releasing thread hands it RW.  If a writer holds RW,
+	 donates to it first.  Interrupts must be off. */
+static void
+rwlock_wait(struct rwlock *rw)
+{
+	struct thread *curr = thread_current();
+
+	if (rw->lock.holder != NULL)
+	{
+		curr->wait_on_lock = &rw->lock;
+		thread_sched->lock_wait(curr, &rw->lock);
+	}
+	thread_block();
+}
+
+/* Makes the highest-priority waiting writer the holder of RW
+	 and wakes it up.  The threads still waiting now wait on that
+	 writer, so they donate to it.  Interrupts must be off. */
+static void
+rwlock_grant_write(struct rwlock *rw)
+{
+	struct list *lists[] = {&rw->write_waiters, &rw->read_waiters};
+	struct list_elem *e;
+	struct thread *writer;
+	size_t i;
+
+	writer = list_entry(list_min(&rw->write_waiters, cmp_priority, NULL),
+											struct thread, elem);
+	list_remove(&writer->elem);
+	writer->wait_on_lock = NULL;
+	rw->lock.holder = writer;
+
+	for (i = 0; i < sizeof lists / sizeof *lists; i++)
+		for (e = list_begin(lists[i]); e != list_end(lists[i]); e = list_next(e))
+		{
+			struct thread *t = list_entry(e, struct thread, elem);
+			t->wait_on_lock = &rw->lock;
+			thread_sched->lock_wait(t, &rw->lock);
+		}
+	thread_unblock(writer);
+}
+
+/* Acquires RW for reading, sleeping until it is available if
+	 necessary.  Waits if a writer holds RW or is waiting for it.
+
+	 This function may sleep, so it must not be called within an
+	 interrupt handler. */
+void rwlock_acquire_read(struct rwlock *rw)
+{
+	enum intr_level old_level;
+	int64_t wait_start = -1;
+
+	ASSERT(rw != NULL);
+	ASSERT(!intr_context());
+	ASSERT(!rwlock_held_by_current_thread(rw));
+
+	old_level = intr_disable();
+	if (rw->lock.holder == NULL && list_empty(&rw->write_waiters))
+		rw->readers++;
+	else
+	{
+		/* The releasing thread counts us in as a reader. */
+		if (lock_profiled(&rw->lock))
+			wait_start = lockstat_now();
+		list_push_back(&rw->read_waiters, &thread_current()->elem);
+		rwlock_wait(rw);
+	}
+	if (lock_profiled(&rw->lock))
+		lockstat_acquired(rw->lock.stats, wait_start, __builtin_return_address(0), false);
+	intr_set_level(old_level);
+}
+
+/* Releases RW, which the running thread holds for reading.  The
+	 last reader out hands RW to a waiting writer. */
+void rwlock_release_read(struct rwlock *rw)
+{
+	enum intr_level old_level;
+
+	ASSERT(rw != NULL);
+
+	old_level = intr_disable();
+	ASSERT(rw->readers > 0);
+	if (--rw->readers == 0 && !list_empty(&rw->write_waiters))
+		rwlock_grant_write(rw);
+	preempt_priority();
+	intr_set_level(old_level);
+}
+
+/* Acquires RW for writing, sleeping until it is available if
+	 necessary.  RW must not already be held by the current
+	 thread, for reading or writing.
+
+	 This function may sleep, so it must not be called within an
+	 interrupt handler. */
+void rwlock_acquire_write(struct rwlock *rw)
+{
+	enum intr_level old_level;
+	int64_t wait_start = -1;
+
+	ASSERT(rw != NULL);
+	ASSERT(!intr_context());
+	ASSERT(!rwlock_held_by_current_thread(rw));
+
+	old_level = intr_disable();
+	if (rw->lock.holder == NULL && rw->readers == 0)
+		rw->lock.holder = thread_current();
+	else
+	{
+		/* The releasing thread makes us the holder. */
+		if (lock_profiled(&rw->lock))
+			wait_start = lockstat_now();
+		list_push_back(&rw->write_waiters, &thread_current()->elem);
+		rwlock_wait(rw);
+	}
+	if (lock_profiled(&rw->lock))
+		lockstat_acquired(rw->lock.stats, wait_start, __builtin_return_address(0), true);
+	intr_set_level(old_level);
+}
+
+/* Releases RW, which the running thread holds for writing.  Lets
+	 in every waiting reader if there are any, otherwise the next
+	 writer. */
+void rwlock_release_write(struct rwlock *rw)
+{
+	struct list_elem *e;
+	enum intr_level old_level;
+
+	ASSERT(rw != NULL);
+	ASSERT(rwlock_held_by_current_thread(rw));
+
+	old_level = intr_disable();
+	thread_sched->lock_release(&rw->lock); // 기다리던 스레드들이 기부한 우선순위 철회
+	if (lock_profiled(&rw->lock))
+		lockstat_released(rw->lock.stats);
+	rw->lock.holder = NULL;
+	for (e = list_begin(&rw->write_waiters); e != list_end(&rw->write_waiters);
+			 e = list_next(e))
+		list_entry(e, struct thread, elem)->wait_on_lock = NULL;
+
+	if (!list_empty(&rw->read_waiters))
+	{
+		while (!list_empty(&rw->read_waiters))
+		{
+			struct thread *t = list_entry(list_pop_front(&rw->read_waiters),
+																		struct thread, elem);
+			t->wait_on_lock = NULL;
+			rw->readers++;
+			thread_unblock(t);
+		}
+	}
+	else if (!list_empty(&rw->write_waiters))
+		rwlock_grant_write(rw);
+	preempt_priority();
+	intr_set_level(old_level);
+}
+
+/* Returns true if the current thread holds RW for writing, false
+	 otherwise.  There is no telling which threads hold it for
+	 reading. */
+bool rwlock_held_by_current_thread(const struct rwlock *rw)
+{
+	ASSERT(rw != NULL);
+
+	return lock_held_by_current_thread(&rw->lock);
+}
+
+/* Initializes sequence lock SL. */
+void seqlock_init(struct seqlock *sl)
+{
+	ASSERT(sl != NULL);
+
+	sl->sequence = 0;
+	spinlock_init(&sl->lock);
+}
+
+/* Starts a read of the data protected by SL, waiting out any
+	 write in progress.  Returns the value to pass to
+	 seqlock_read_retry() once the data has been copied. */
+unsigned seqlock_read_begin(const struct seqlock *sl)
+{
+	unsigned seq;
+
+	while ((seq = __atomic_load_n(&sl->sequence, __ATOMIC_ACQUIRE)) & 1)
+		asm volatile("pause" : : : "memory");
+	return seq;
+}
+
+/* Returns true if the data read since seqlock_read_begin()
+	 returned SEQ may be torn by a write and must be read again. */
+bool seqlock_read_retry(const struct seqlock *sl, unsigned seq)
+{
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	return __atomic_load_n(&sl->sequence, __ATOMIC_RELAXED) != seq;
+}
+
+/* Starts writing the data protected by SL.  Interrupts must be
+	 off, as for spinlock_acquire(). */
+void seqlock_write_begin(struct seqlock *sl)
+{
+	spinlock_acquire(&sl->lock);
+	__atomic_store_n(&sl->sequence, sl->sequence + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+/* Finishes writing the data protected by SL. */
+void seqlock_write_end(struct seqlock *sl)
+{
+	__atomic_store_n(&sl->sequence, sl->sequence + 1, __ATOMIC_RELEASE);
+	spinlock_release(&sl->lock);
+}
 
 /* Initializes condition variable COND.  A condition variable
 	 allows one piece of code to signal a condition and cooperating
@@ -357,7 +731,7 @@ void cond_init(struct condition *cond)
 {
 	ASSERT(cond != NULL);
 
-	list_init(&cond->waiters);
+	waitq_init(&cond->waiters);
 }
 
 /* Atomically releases LOCK and waits for COND to be signaled by
@@ -380,37 +754,23 @@ void cond_init(struct condition *cond)
 	 interrupt handler.  This function may be called with
 	 interrupts disabled, but interrupts will be turned back on if
 	 we need to sleep. */
-
-// semaphore_elem을 통해 semaphore의 대기 리스트로 들어간다
-// 한번에 들어갈 수 없으므로 구조체를 이용해 두번 타고 들어간다
-bool cmp_sema_priority(const struct list_elem *a, const struct list_elem *b, void *aux UNUSED)
-{
-	struct semaphore_elem *sema_a = list_entry(a, struct semaphore_elem, elem);
-	struct semaphore_elem *sema_b = list_entry(b, struct semaphore_elem, elem);
-
-	struct list *waiters_a = &(sema_a->semaphore.waiters);
-	struct list *waiters_b = &(sema_b->semaphore.waiters);
-
-	// list가 비어있을수도 있으므로 begin
-	struct thread *root_a = list_entry(list_begin(waiters_a), struct thread, elem);
-	struct thread *root_b = list_entry(list_begin(waiters_b), struct thread, elem);
-
-	return root_a->priority > root_b->priority;
-}
 void cond_wait(struct condition *cond, struct lock *lock)
 {
-	struct semaphore_elem waiter;
+	struct thread *curr = thread_current();
+	enum intr_level old_level;
 
 	ASSERT(cond != NULL);
 	ASSERT(lock != NULL);
 	ASSERT(!intr_context());
 	ASSERT(lock_held_by_current_thread(lock));
 
-	sema_init(&waiter.semaphore, 0);
-	// list_push_back (&cond->waiters, &waiter.elem);
-	list_insert_ordered(&cond->waiters, &waiter.elem, cmp_sema_priority, NULL);
+	old_level = intr_disable();
+	waitq_push(&cond->waiters, curr);
 	lock_release(lock);
-	sema_down(&waiter.semaphore);
+	// lock_release()에서 양보한 사이에 이미 신호를 받았으면 대기 큐에서 빠져 있다
+	if (curr->waitq != NULL)
+		thread_block();
+	intr_set_level(old_level);
 	lock_acquire(lock);
 }
 
@@ -423,18 +783,24 @@ void cond_wait(struct condition *cond, struct lock *lock)
 	 interrupt handler. */
 void cond_signal(struct condition *cond, struct lock *lock UNUSED)
 {
+	enum intr_level old_level;
+	struct thread *t;
+
 	ASSERT(cond != NULL);
 	ASSERT(lock != NULL);
 	ASSERT(!intr_context());
 	ASSERT(lock_held_by_current_thread(lock));
 
-	if (!list_empty(&cond->waiters))
+	old_level = intr_disable();
+	if (!waitq_empty(&cond->waiters))
 	{
-		list_sort(&cond->waiters, cmp_sema_priority, NULL);
-		sema_up(&list_entry(list_pop_front(&cond->waiters),
-												struct semaphore_elem, elem)
-								 ->semaphore);
+		// 가장 높은 우선순위의 대기자를 꺼낸다. cond_wait()에서 아직 잠들기 전이면 깨울 필요가 없다
+		t = waitq_pop(&cond->waiters);
+		if (t->status == THREAD_BLOCKED)
+			thread_unblock(t);
+		preempt_priority();
 	}
+	intr_set_level(old_level);
 }
 
 /* Wakes up all threads, if any, waiting on COND (protected by
@@ -448,6 +814,6 @@ void cond_broadcast(struct condition *cond, struct lock *lock)
 	ASSERT(cond != NULL);
 	ASSERT(lock != NULL);
 
-	while (!list_empty(&cond->waiters))
+	while (!waitq_empty(&cond->waiters))
 		cond_signal(cond, lock);
 }
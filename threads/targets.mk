@@ -1,9 +1,20 @@
 threads_SRC  = threads/init.c		# Main program.
 threads_SRC += threads/thread.c		# Thread management core.
+threads_SRC += threads/runqueue.c	# Ready thread run queue.
+threads_SRC += threads/sched_stride.c	# Stride scheduling class.
+threads_SRC += threads/sched_cfs.c	# Completely fair scheduling class.
+threads_SRC += threads/sched_edf.c	# Earliest-deadline-first class.
 threads_SRC += threads/interrupt.c	# Interrupt core.
 threads_SRC += threads/intr-stubs.S	# Interrupt stubs.
+threads_SRC += threads/switch.S		# Thread context switch.
 threads_SRC += threads/synch.c		# Synchronization.
+threads_SRC += threads/waitq.c		# Priority wait queues.
+threads_SRC += threads/lockstat.c	# Lock contention profiling.
 threads_SRC += threads/palloc.c		# Page allocator.
 threads_SRC += threads/malloc.c		# Subpage allocator.
+threads_SRC += threads/slab.c		# Slab object caches.
+threads_SRC += threads/vmalloc.c	# Virtually contiguous allocator.
+threads_SRC += threads/workqueue.c	# Deferred work in worker threads.
+threads_SRC += threads/trace.c		# Scheduler event tracing.
 threads_SRC += threads/start.S		# Startup code.
 threads_SRC += threads/mmu.c		    # Memory management unit related things.
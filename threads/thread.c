@@ -4,12 +4,19 @@
 #include <random.h>
 #include <stdio.h>
 #include <string.h>
+#include "threads/cpu.h"
 #include "threads/flags.h"
 #include "threads/interrupt.h"
 #include "threads/intr-stubs.h"
 #include "threads/palloc.h"
+#include "threads/runqueue.h"
+#include "threads/sched.h"
+#include "threads/switch.h"
 #include "threads/synch.h"
+#include "threads/trace.h"
 #include "threads/vaddr.h"
+#include "threads/waitq.h"
+#include "devices/timer.h"
 
 #include "threads/fixed_point.h"
 
@@ -27,16 +34,19 @@
 	 Do not modify this value. */
 #define THREAD_BASIC 0xd42df210
 
-/* List of processes in THREAD_READY state, that is, processes
-	 that are ready to run but not actually running. */
-static struct list ready_list;
+/* Per-CPU state: run queue of processes in THREAD_READY state,
+	 that is, processes that are ready to run but not actually
+	 running, idle thread, destruction requests and statistics.
+	 See cpu.h. */
+struct cpu cpus[MAX_CPUS];
 
-static struct list sleep_list;
+/* Number of CPUs online, which are cpus[0] through
+	 cpus[cpu_cnt - 1]. */
+int cpu_cnt;
 
+/* List of all threads, and the spinlock protecting it. */
 static struct list all_list;
-
-/* Idle thread. */
-static struct thread *idle_thread;
+static struct spinlock all_lock;
 
 /* Initial thread, the thread running init.c:main(). */
 static struct thread *initial_thread;
@@ -44,37 +54,40 @@ static struct thread *initial_thread;
 /* Lock used by allocate_tid(). */
 static struct lock tid_lock;
 
-/* Thread destruction requests */
-static struct list destruction_req;
-
-/* Statistics. */
-static long long idle_ticks;	 /* # of timer ticks spent idle. */
-static long long kernel_ticks; /* # of timer ticks in kernel threads. */
-static long long user_ticks;	 /* # of timer ticks in user programs. */
-
-/* Scheduling. */
-#define TIME_SLICE 4					/* # of timer ticks to give each thread. */
-static unsigned thread_ticks; /* # of timer ticks since last yield. */
-
 /* If false (default), use round-robin scheduler.
 	 If true, use multi-level feedback queue scheduler.
 	 Controlled by kernel command-line option "-o mlfqs". */
 bool thread_mlfqs;
 
+/* Scheduling policy.  See sched.h. */
+const struct sched_class *thread_sched = &sched_priority_class;
+
 int load_avg;
+static struct seqlock load_avg_seqlock; /* Guards load_avg for lock-free readers. */
+
+/* MLFQS bookkeeping, protected by all_lock. */
+static struct list mlfqs_dirty_list;			/* Threads whose recent_cpu changed. */
+static struct semaphore mlfqs_decay_sema; /* Wakes mlfqs_decay_daemon(). */
+static int decay_load_avg;								/* load_avg to decay recent_cpu with. */
 
 static void kernel_thread(thread_func *, void *aux);
 
 static void idle(void *aux UNUSED);
-static struct thread *next_thread_to_run(void);
+static struct thread *next_thread_to_run(struct cpu *);
 static void init_thread(struct thread *, const char *name, int priority);
+static void cpu_init(struct cpu *, int id);
+static void rq_enqueue(struct cpu *, struct thread *);
 static void do_schedule(int status);
 static void schedule(void);
 static tid_t allocate_tid(void);
+static void mlfqs_decay_daemon(void *aux);
 
 /* Returns true if T appears to point to a valid thread. */
 #define is_thread(t) ((t) != NULL && (t)->magic == THREAD_MAGIC)
 
+/* Returns true if T is its CPU's idle thread. */
+#define is_idle_thread(t) ((t) == (t)->cpu->idle_thread)
+
 /* Returns the running thread.
  * Read the CPU's stack pointer `rsp', and then round that
  * down to the start of a page.  Since `struct thread' is
@@ -90,8 +103,7 @@ static uint64_t gdt[3] = {0, 0x00af9a000000ffff, 0x00cf92000000ffff};
 // 우선순위 비교
 bool cmp_priority(const struct list_elem *a, const struct list_elem *b, void *aux UNUSED);
 
-bool less_wake_up_tick(const struct list_elem *a, const struct list_elem *b, void *aux UNUSED);
-void thread_wake_up(int64_t ticks);
+static timer_func thread_wake_up;
 
 /* Initializes the threading system by transforming the code
 	 that's currently running into a thread.  This can't work in
@@ -119,19 +131,43 @@ void thread_init(void)
 	lgdt(&gdt_ds);
 
 	/* Init the globla thread context */
-	lock_init(&tid_lock);
-	list_init(&ready_list);
-	list_init(&destruction_req);
-
-	list_init(&sleep_list);
+	lock_init_named(&tid_lock, "tid");
+	cpu_init(&cpus[0], 0);
+	cpu_cnt = 1;
 
 	list_init(&all_list);
+	spinlock_init(&all_lock);
+	list_init(&mlfqs_dirty_list);
+	sema_init(&mlfqs_decay_sema, 0);
 
 	/* Set up a thread structure for the running thread. */
 	initial_thread = running_thread();
 	init_thread(initial_thread, "main", PRI_DEFAULT);
 	initial_thread->status = THREAD_RUNNING;
 	initial_thread->tid = allocate_tid();
+	cpus[0].curr = initial_thread;
+	trace_record_create(initial_thread->tid, initial_thread->name);
+}
+
+/* Initializes C as CPU number ID with an empty run queue. */
+static void
+cpu_init(struct cpu *c, int id)
+{
+	memset(c, 0, sizeof *c);
+	c->id = id;
+	spinlock_init(&c->rq_lock);
+	sched_edf_class.init(c);
+	thread_sched->init(c);
+	list_init(&c->destruction_req);
+}
+
+/* Returns the CPU running the current thread.  Interrupts should
+	 be off, or the thread could move to another CPU before the
+	 caller uses the result. */
+struct cpu *
+this_cpu(void)
+{
+	return running_thread()->cpu;
 }
 
 /* Starts preemptive thread scheduling by enabling interrupts.
@@ -143,39 +179,65 @@ void thread_start(void)
 	sema_init(&idle_started, 0);
 	thread_create("idle", PRI_MIN, idle, &idle_started);
 	load_avg = LOAD_AVG_DEFAULT;
+	seqlock_init(&load_avg_seqlock);
 	/* Start preemptive thread scheduling. */
 	intr_enable();
+	thread_sched->start();
 
 	/* Wait for the idle thread to initialize idle_thread. */
 	sema_down(&idle_started);
 }
 
 /* Called by the timer interrupt handler at each timer tick.
+	 USER is true if the tick interrupted user mode.
 	 Thus, this function runs in an external interrupt context. */
-void thread_tick(void)
+void thread_tick(bool user)
 {
+	struct cpu *c = this_cpu();
 	struct thread *t = thread_current();
 
 	/* Update statistics. */
-	if (t == idle_thread)
-		idle_ticks++;
+	if (t == c->idle_thread)
+		c->idle_ticks++;
 #ifdef USERPROG
 	else if (t->pml4 != NULL)
-		user_ticks++;
+		c->user_ticks++;
 #endif
 	else
-		kernel_ticks++;
+		c->kernel_ticks++;
+
+	/* Per-thread accounting. */
+	if (t != c->idle_thread)
+	{
+		if (user)
+			t->rusage.ru_utime++;
+		else
+			t->rusage.ru_stime++;
+	}
 
 	/* Enforce preemption. */
-	if (++thread_ticks >= TIME_SLICE)
+	if (t->sched->tick(c, t))
+	{
+		trace_record(TRACE_PREEMPT, t->tid, TRACE_PREEMPT_SLICE, 0);
 		intr_yield_on_return();
+	}
 }
 
 /* Prints thread statistics. */
 void thread_print_stats(void)
 {
+	long long idle_ticks = 0, kernel_ticks = 0, user_ticks = 0;
+	int i;
+
+	for (i = 0; i < cpu_cnt; i++)
+	{
+		idle_ticks += cpus[i].idle_ticks;
+		kernel_ticks += cpus[i].kernel_ticks;
+		user_ticks += cpus[i].user_ticks;
+	}
 	printf("Thread: %lld idle ticks, %lld kernel ticks, %lld user ticks\n",
 				 idle_ticks, kernel_ticks, user_ticks);
+	edf_print_stats();
 }
 
 /* Creates a new kernel thread named NAME with the given initial
@@ -209,6 +271,7 @@ tid_t thread_create(const char *name, int priority,
 	/* Initialize thread. */
 	init_thread(t, name, priority);
 	tid = t->tid = allocate_tid();
+	trace_record_create(tid, t->name);
 
 	/* Call the kernel_thread if it scheduled.
 	 * Note) rdi is 1st argument, and rsi is 2nd argument. */
@@ -222,21 +285,12 @@ tid_t thread_create(const char *name, int priority,
 	t->tf.eflags = FLAG_IF;
 
 	// Project 2
-	t->file_descriptor_table = palloc_get_multiple(PAL_ZERO, FDT_PAGES);
-	if (t->file_descriptor_table == NULL)
-	{
-		return TID_ERROR;
-	}
+	// FDT는 프로세스를 만드는 initd()와 __do_fork()가 할당한다. 유저 스레드는 메인 스레드의 것을 같이 쓴다
 	list_push_back(&thread_current()->child_list, &t->child_elem); // 현재 스레드의 자식으로 추가
 
 	/* Add to run queue. */
 	thread_unblock(t);
-
-	/* modify priority if not MLFQS */
-	if (!thread_mlfqs)
-	{
-		preempt_priority();
-	}
+	preempt_priority();
 
 	return tid;
 }
@@ -251,6 +305,7 @@ void thread_block(void)
 {
 	ASSERT(!intr_context());
 	ASSERT(intr_get_level() == INTR_OFF);
+	trace_record(TRACE_BLOCK, thread_tid(), 0, 0);
 	thread_current()->status = THREAD_BLOCKED;
 	schedule();
 }
@@ -274,17 +329,41 @@ bool cmp_priority(const struct list_elem *a, const struct list_elem *b, void *au
 void thread_unblock(struct thread *t)
 {
 	enum intr_level old_level;
+	struct cpu *c;
 
 	ASSERT(is_thread(t));
 
 	old_level = intr_disable();
 	ASSERT(t->status == THREAD_BLOCKED);
-	// list_push_back(&ready_list, &t->elem);
-	list_insert_ordered(&ready_list, &t->elem, cmp_priority, NULL);
 	t->status = THREAD_READY;
+	c = t->cpu; // 마지막으로 실행된 CPU의 run queue에서 기다린다
+	// 인터럽트 핸들러가 깨운 경우 깨운 스레드는 -1로 기록
+	trace_record(TRACE_WAKEUP, t->tid, intr_context() ? -1 : thread_tid(), c->id);
+	rq_enqueue(c, t);
 	intr_set_level(old_level);
 }
 
+/* Returns the number of threads running or waiting to run on C.
+	 Reads C's run queue without its lock, so the result is only a
+	 hint. */
+static size_t
+cpu_load(const struct cpu *c)
+{
+	return c->nr_ready + (c->curr != c->idle_thread);
+}
+
+/* Puts T on C's run queue.  Interrupts must be off. */
+static void
+rq_enqueue(struct cpu *c, struct thread *t)
+{
+	spinlock_acquire(&c->rq_lock);
+	t->cpu = c;
+	t->ready_since = timer_ticks();
+	c->nr_ready++;
+	t->sched->enqueue(c, t);
+	spinlock_release(&c->rq_lock);
+}
+
 /* Returns the name of the running thread. */
 const char *
 thread_name(void)
@@ -327,6 +406,10 @@ void thread_exit(void)
 	process_exit();
 #endif
 
+	/* Give back the CPU bandwidth reserved by thread_set_deadline(). */
+	if (thread_current()->sched == &sched_edf_class)
+		thread_set_deadline(0, 0, 0);
+
 	/* Just set our status to dying and schedule another process.
 		 We will be destroyed during the call to schedule_tail(). */
 	intr_disable();
@@ -344,71 +427,46 @@ void thread_yield(void)
 	ASSERT(!intr_context()); // 인터럽트 처리중에 호출되지 않았는지 확인
 
 	old_level = intr_disable(); // 현재 인터럽트 레벨을 비활성화 -> 다른 인터럽트의 방해 피하기 위해
-	if (curr != idle_thread)		// 현재 스레드가 idle이 아닐 경우
-		// list_push_back(&ready_list, &curr->elem); // 준비리스트 뒤쪽에 추가
-		list_insert_ordered(&ready_list, &curr->elem, cmp_priority, NULL); // 우선순위 확인하여 준비리스트에 삽입
+	if (!is_idle_thread(curr))		// 현재 스레드가 idle이 아닐 경우
+		rq_enqueue(curr->cpu, curr); // 자기 우선순위 큐의 맨 뒤에 삽입
 	do_schedule(THREAD_READY);																					 // 스레드의 상태를 READY로 설정, 스케줄러 호출, 새로운 스레드를 선택하고 실행 (스레드가 자발적으로 CPU양보)
 	intr_set_level(old_level);																					 // 인터럽트 레벨 복원 -> 활성화
 }
 
-// 두 스레드를 비교, list_elem 포인터를 실제 구조체로 변환 후 각 스레드의 wakeup_tick을 비교 a가 작으면 true
-bool less_wake_up_tick(const struct list_elem *a, const struct list_elem *b, void *aux UNUSED)
-{
-	const struct thread *thread_a = list_entry(a, struct thread, elem);
-	const struct thread *thread_b = list_entry(b, struct thread, elem);
-	return thread_a->wakeup_tick < thread_b->wakeup_tick;
-}
-
+/* Puts the current thread to sleep until timer tick TICKS.
+	 The wakeup is a one-shot timer event that lives on this
+	 thread's stack, which stays valid while the thread is blocked. */
 void thread_sleep(int64_t ticks)
 {
 	struct thread *curr = thread_current();
+	struct timer_event wakeup;
 	enum intr_level old_level;
 	ASSERT(!intr_context())
 
-	if (curr == idle_thread) // 현재 스레드가 유휴 스레드이면 종료
+	if (is_idle_thread(curr)) // 현재 스레드가 유휴 스레드이면 종료
 		return;
 
-	old_level = intr_disable();																							// 인터럽트 비활성화 후 이전 레벨을 저장
-	curr->wakeup_tick = ticks;																							// 현재 스레드의 wakeup_tick 설정
-	list_insert_ordered(&sleep_list, &curr->elem, less_wake_up_tick, NULL); // 슬립 스레드에 순서대로 삽입
-	// list_push_back(&sleep_list, &curr->elem); // 슬립 스레드 뒤에다가 삽입
+	old_level = intr_disable(); // 인터럽트 비활성화 후 이전 레벨을 저장
+	timer_event_init(&wakeup, thread_wake_up, curr);
+	timer_arm(&wakeup, ticks); // ticks에 깨워줄 타이머 등록
 	thread_block();						 // 스레드 차단하여 CPU양보
 	intr_set_level(old_level); // 인터럽트 레벨 복원
 }
 
-void thread_wake_up(int64_t ticks)
+/* Timer callback that wakes up the sleeping thread T_. */
+static void
+thread_wake_up(void *t_)
 {
-	enum intr_level old_level;
-	old_level = intr_disable();
-	struct list_elem *e = list_begin(&sleep_list); // 슬립리스트의 시작 엘리멘트 포인터
-	while (e != list_end(&sleep_list))						 // 시작부터 끝까지 순회
-	{
-		struct thread *t = list_entry(e, struct thread, elem); // e가 가리키는 thread 구조체
-		if (t->wakeup_tick <= ticks)													 // wakeup_tick이 현재 ticks보다 작거나 같으면
-		{
-			e = list_remove(e); // 지우고 다음 스레드를 가리킨다
-			thread_unblock(t);	// 스레드 상태를 BLOCKED 에서 READY로 변경
-			if (!thread_mlfqs)
-			{
-				preempt_priority(); // mlfqs???
-			}
-		}
-		else
-		{
-			break;
-		}
-	}
-	intr_set_level(old_level);
+	struct thread *t = t_;
+
+	thread_unblock(t); // 스레드 상태를 BLOCKED 에서 READY로 변경
+	preempt_priority();
 }
 
 /* Sets the current thread's priority to NEW_PRIORITY. */
 void thread_set_priority(int new_priority)
 {
-	if (thread_mlfqs)
-		return;
-	struct thread *current_thread = thread_current(); // 현재 스레드 가져오기
-	current_thread->init_priority = new_priority;			// 새로 들어온 우선순위를 현재 우선순위로
-	update_priority_before_donations();								// thread의 우선순위가 변경되면 donaitons 정보를 갱신
+	thread_sched->set_priority(new_priority);
 	preempt_priority();
 }
 
@@ -419,14 +477,33 @@ int thread_get_priority(void)
 }
 
 /* Sets the current thread's nice value to NICE. */
-void thread_set_nice(int nice UNUSED)
+void thread_set_nice(int nice)
 {
 	// 현재 스레드의 nice 값을 새 값으로 설정
-	enum intr_level old_level = intr_disable();
-	thread_current()->nice = nice;
-	mlfqs_calculate_priority(thread_current());
+	thread_sched->set_nice(nice);
 	preempt_priority();
+}
+
+/* Sets the current thread's ticket count to TICKETS, its share
+	 of the CPU under the stride scheduler.  Returns false if
+	 TICKETS is outside TICKETS_MIN...TICKETS_MAX. */
+bool thread_set_tickets(int tickets)
+{
+	enum intr_level old_level;
+
+	if (tickets < TICKETS_MIN || tickets > TICKETS_MAX)
+		return false;
+
+	old_level = intr_disable();
+	thread_current()->tickets = tickets;
 	intr_set_level(old_level);
+	return true;
+}
+
+/* Returns the current thread's ticket count. */
+int thread_get_tickets(void)
+{
+	return thread_current()->tickets;
 }
 
 /* Returns the current thread's nice value. */
@@ -443,9 +520,14 @@ int thread_get_nice(void)
 int thread_get_load_avg(void)
 {
 	// 현재 시스템의 load_avg * 100 값을 반환
-	enum intr_level old_level = intr_disable();
-	int load_avg_value = fp_to_int_round(mult_mixed(load_avg, 100));
-	intr_set_level(old_level);
+	unsigned seq;
+	int load_avg_value;
+
+	do
+	{
+		seq = seqlock_read_begin(&load_avg_seqlock);
+		load_avg_value = fp_to_int_round(mult_mixed(load_avg, 100));
+	} while (seqlock_read_retry(&load_avg_seqlock, seq));
 	// printf("load_avg_value : %d\n", load_avg_value);
 	return load_avg_value;
 }
@@ -475,7 +557,7 @@ idle(void *idle_started_ UNUSED)
 {
 	struct semaphore *idle_started = idle_started_;
 
-	idle_thread = thread_current();
+	this_cpu()->idle_thread = thread_current();
 	sema_up(idle_started);
 
 	for (;;)
@@ -484,6 +566,27 @@ idle(void *idle_started_ UNUSED)
 		intr_disable();
 		thread_block();
 
+		/* Nothing is ready to run, so zero free pages ahead of
+			 PAL_ZERO requests, one at a time, until a thread wakes up
+			 or there is nothing left to zero.  The idle thread is never
+			 preempted, so check for ready threads after each page. */
+		for (;;)
+		{
+			bool zeroed;
+
+			intr_enable();
+			zeroed = palloc_prezero();
+			intr_disable();
+			if (!zeroed || this_cpu()->nr_ready > 0)
+				break;
+		}
+		if (this_cpu()->nr_ready > 0)
+			continue;
+
+		/* With -tickless, stop the periodic timer interrupt until the
+			 next timer event is due. */
+		timer_idle_enter();
+
 		/* Re-enable interrupts and wait for the next one.
 
 			 The `sti' instruction disables interrupts until the
@@ -516,6 +619,12 @@ kernel_thread(thread_func *function, void *aux)
 static void
 init_thread(struct thread *t, const char *name, int priority)
 {
+	struct thread *parent = running_thread();
+	bool inherit = parent != t && is_thread(parent);
+	// 티켓과 vruntime은 생성한 스레드에서 상속 (main 스레드는 기본값)
+	int tickets = inherit ? parent->tickets : TICKETS_DEFAULT;
+	int64_t vruntime = inherit ? parent->vruntime : 0;
+
 	ASSERT(t != NULL);
 	ASSERT(PRI_MIN <= priority && priority <= PRI_MAX);
 	ASSERT(name != NULL);
@@ -530,33 +639,85 @@ init_thread(struct thread *t, const char *name, int priority)
 	t->init_priority = priority; // 오리지널 우선순위
 	t->wait_on_lock = NULL;
 	list_init(&(t->donations));
+	t->waitq = NULL;
 
 	t->nice = NICE_DEFAULT;
 	t->recent_cpu = RECENT_CPU_DEFAULT;
+
+	t->tickets = tickets;
+	t->pass = 0;
+	t->vruntime = vruntime;
+
+	/* Deadlines are not inherited: every thread starts out in the
+		 class chosen at boot. */
+	t->sched = thread_sched;
+
+	/* Threads start out on the bootstrap CPU. */
+	t->cpu = &cpus[0];
+
+	enum intr_level old_level = intr_disable();
+	spinlock_acquire(&all_lock);
 	list_push_back(&all_list, &t->all_elem); // 새 리스트를 만들면 초기화
 																					 // main스레드는 thread_start()를 실행하지 않으므로
+	spinlock_release(&all_lock);
+	intr_set_level(old_level);
 
 	/* Project2 */
 	t->exit_status = 0;
 	t->fdidx = 2; // 2번 부터
+	lock_init(&t->fdt_lock);
 	list_init(&(t->child_list));
 	sema_init(&t->load_sema, 0);
 	sema_init(&t->wait_sema, 0);
 	sema_init(&t->exit_sema, 0);
+
+	// 유저 스레드는 process.c에서 leader를 바꾼다
+	t->leader = t;
+	list_init(&t->threads);
+	t->live_threads = 0;
+	sema_init(&t->threads_sema, 0);
+	t->exiting = false;
+	t->fs_base = 0;
 }
 
-/* Chooses and returns the next thread to be scheduled.  Should
-	 return a thread from the run queue, unless the run queue is
-	 empty.  (If the running thread can continue running, then it
-	 will be in the run queue.)  If the run queue is empty, return
-	 idle_thread. */
+/* Removes and returns the thread C should run next, or NULL if
+	 C's run queues are empty.  Threads with deadlines come first.
+	 C->rq_lock must be held. */
 static struct thread *
-next_thread_to_run(void)
+rq_pick_next(struct cpu *c)
 {
-	if (list_empty(&ready_list))
-		return idle_thread;
-	else
-		return list_entry(list_pop_front(&ready_list), struct thread, elem);
+	struct thread *t = sched_edf_class.pick_next(c);
+
+	return t != NULL ? t : thread_sched->pick_next(c);
+}
+
+/* Returns true if running thread T should give up C to a thread
+	 on C's run queues.  Interrupts must be off. */
+static bool
+rq_yield_check(struct cpu *c, struct thread *t)
+{
+	if (sched_edf_class.yield_check(c, t))
+		return true;
+	return t->sched == thread_sched && thread_sched->yield_check(c, t);
+}
+
+/* Chooses and returns the next thread to be scheduled on C.
+	 Should return a thread from C's run queue, unless the run
+	 queue is empty.  (If the running thread can continue running,
+	 then it will be in the run queue.)  If the run queue is empty,
+	 returns C's idle thread. */
+static struct thread *
+next_thread_to_run(struct cpu *c)
+{
+	struct thread *next = NULL;
+
+	spinlock_acquire(&c->rq_lock);
+	next = rq_pick_next(c);
+	if (next != NULL)
+		c->nr_ready--;
+	spinlock_release(&c->rq_lock);
+
+	return next != NULL ? next : c->idle_thread;
 }
 
 /* Use iretq to launch the thread */
@@ -587,73 +748,28 @@ void do_iret(struct intr_frame *tf)
 			: : "g"((uint64_t)tf) : "memory");
 }
 
-/* Switching the thread by activating the new thread's page
-	 tables, and, if the previous thread is dying, destroying it.
+/* Switches from the running thread to TH.
 
-	 At this function's invocation, we just switched from thread
-	 PREV, the new thread is already running, and interrupts are
-	 still disabled.
+	 The running thread saves only its callee-saved registers on its
+	 own stack (see switch.S) and resumes by returning from this
+	 function when another thread switches back to it.  TH is
+	 resumed the same way if it was switched out before.  A thread
+	 that has never run has no such saved context, only the
+	 `struct intr_frame' set up by thread_create(), so it is started
+	 from that frame through do_iret() instead.
 
-	 It's not safe to call printf() until the thread switch is
-	 complete.  In practice that means that printf()s should be
-	 added at the end of the function. */
+	 Interrupts must be off. */
 static void
 thread_launch(struct thread *th)
 {
-	uint64_t tf_cur = (uint64_t)&running_thread()->tf;
-	uint64_t tf = (uint64_t)&th->tf;
+	struct thread *curr = running_thread();
+
 	ASSERT(intr_get_level() == INTR_OFF);
 
-	/* The main switching logic.
-	 * We first restore the whole execution context into the intr_frame
-	 * and then switching to the next thread by calling do_iret.
-	 * Note that, we SHOULD NOT use any stack from here
-	 * until switching is done. */
-	__asm __volatile(
-			/* Store registers that will be used. */
-			"push %%rax\n"
-			"push %%rbx\n"
-			"push %%rcx\n"
-			/* Fetch input once */
-			"movq %0, %%rax\n"
-			"movq %1, %%rcx\n"
-			"movq %%r15, 0(%%rax)\n"
-			"movq %%r14, 8(%%rax)\n"
-			"movq %%r13, 16(%%rax)\n"
-			"movq %%r12, 24(%%rax)\n"
-			"movq %%r11, 32(%%rax)\n"
-			"movq %%r10, 40(%%rax)\n"
-			"movq %%r9, 48(%%rax)\n"
-			"movq %%r8, 56(%%rax)\n"
-			"movq %%rsi, 64(%%rax)\n"
-			"movq %%rdi, 72(%%rax)\n"
-			"movq %%rbp, 80(%%rax)\n"
-			"movq %%rdx, 88(%%rax)\n"
-			"pop %%rbx\n" // Saved rcx
-			"movq %%rbx, 96(%%rax)\n"
-			"pop %%rbx\n" // Saved rbx
-			"movq %%rbx, 104(%%rax)\n"
-			"pop %%rbx\n" // Saved rax
-			"movq %%rbx, 112(%%rax)\n"
-			"addq $120, %%rax\n"
-			"movw %%es, (%%rax)\n"
-			"movw %%ds, 8(%%rax)\n"
-			"addq $32, %%rax\n"
-			"call __next\n" // read the current rip.
-			"__next:\n"
-			"pop %%rbx\n"
-			"addq $(out_iret -  __next), %%rbx\n"
-			"movq %%rbx, 0(%%rax)\n" // rip
-			"movw %%cs, 8(%%rax)\n"	 // cs
-			"pushfq\n"
-			"popq %%rbx\n"
-			"mov %%rbx, 16(%%rax)\n" // eflags
-			"mov %%rsp, 24(%%rax)\n" // rsp
-			"movw %%ss, 32(%%rax)\n"
-			"mov %%rcx, %%rdi\n"
-			"call do_iret\n"
-			"out_iret:\n"
-			: : "g"(tf_cur), "g"(tf) : "memory");
+	if (th->ctx_rsp != 0)
+		switch_context(&curr->ctx_rsp, th->ctx_rsp);
+	else
+		switch_to_frame(&curr->ctx_rsp, &th->tf);
 }
 
 /* Schedules a new process. At entry, interrupts must be off.
@@ -665,10 +781,11 @@ do_schedule(int status)
 {
 	ASSERT(intr_get_level() == INTR_OFF);
 	ASSERT(thread_current()->status == THREAD_RUNNING);
-	while (!list_empty(&destruction_req))
+	struct list *destruction_req = &this_cpu()->destruction_req;
+	while (!list_empty(destruction_req))
 	{
 		struct thread *victim =
-				list_entry(list_pop_front(&destruction_req), struct thread, elem);
+				list_entry(list_pop_front(destruction_req), struct thread, elem);
 		palloc_free_page(victim);
 	}
 	thread_current()->status = status;
@@ -679,16 +796,19 @@ static void
 schedule(void)
 {
 	struct thread *curr = running_thread();
-	struct thread *next = next_thread_to_run();
+	struct cpu *c = curr->cpu;
+	struct thread *next = next_thread_to_run(c);
 
 	ASSERT(intr_get_level() == INTR_OFF);
 	ASSERT(curr->status != THREAD_RUNNING);
 	ASSERT(is_thread(next));
 	/* Mark us as running. */
 	next->status = THREAD_RUNNING;
+	next->cpu = c;
+	c->curr = next;
 
 	/* Start new time slice. */
-	thread_ticks = 0;
+	c->thread_ticks = 0;
 
 #ifdef USERPROG
 	/* Activate the new address space. */
@@ -707,10 +827,24 @@ schedule(void)
 		if (curr && curr->status == THREAD_DYING && curr != initial_thread)
 		{
 			ASSERT(curr != next);
+			spinlock_acquire(&all_lock);
 			list_remove(&curr->all_elem); // Remove from all_list
-			list_push_back(&destruction_req, &curr->elem);
+			if (curr->mlfqs_dirty)
+				list_remove(&curr->mlfqs_elem);
+			spinlock_release(&all_lock);
+			list_push_back(&c->destruction_req, &curr->elem);
 		}
 
+		trace_record(TRACE_SWITCH, curr->tid, next->tid, curr->status);
+
+		/* 막혀서(또는 종료해서) 양보했으면 자발적, 준비 상태로 밀려났으면 비자발적 */
+		if (curr->status == THREAD_READY)
+			curr->rusage.ru_nivcsw++;
+		else
+			curr->rusage.ru_nvcsw++;
+		if (next != c->idle_thread)
+			next->rusage.ru_wtime += timer_ticks() - next->ready_since;
+
 		/* Before switching the thread, we first save the information
 		 * of current running. */
 		thread_launch(next);
@@ -733,85 +867,358 @@ allocate_tid(void)
 
 void preempt_priority(void)
 {
-	if (thread_current() == idle_thread)
+	struct thread *curr = thread_current();
+	enum intr_level old_level;
+	bool preempt;
+
+	if (is_idle_thread(curr))
 		return;
-	if (list_empty(&ready_list))
-	{
+
+	old_level = intr_disable();
+	// ready에 현재 실행중인 스레드보다 먼저 실행되어야 할 스레드가 있으면 CPU할당
+	preempt = rq_yield_check(curr->cpu, curr);
+	intr_set_level(old_level);
+
+	if (!preempt)
 		return;
-	}
-	struct thread *curr = thread_current();
-	struct thread *ready = list_entry(list_front(&ready_list), struct thread, elem);
-	// ready에 현재 실행중이 스레드보다 우선순위가 높은 스레드가 있으면 CPU할당
-	if (curr->priority < ready->priority)
-	{
+	trace_record(TRACE_PREEMPT, curr->tid, TRACE_PREEMPT_READY, 0);
+	// 인터럽트 핸들러 안에서는 바로 yield할 수 없으므로 핸들러가 끝날 때 양보
+	if (intr_context())
+		intr_yield_on_return();
+	else
 		thread_yield();
+}
+
+/* Sets T's effective priority to PRIORITY.  A ready thread is
+	 moved to the run queue level for its new priority, behind any
+	 threads already waiting there. */
+void thread_update_priority(struct thread *t, int priority)
+{
+	enum intr_level old_level;
+
+	ASSERT(is_thread(t));
+	ASSERT(PRI_MIN <= priority && priority <= PRI_MAX);
+
+	old_level = intr_disable();
+	if (t->status == THREAD_READY && t->priority != priority)
+	{
+		struct cpu *c = t->cpu;
+
+		spinlock_acquire(&c->rq_lock);
+		t->priority = priority;
+		t->sched->priority_changed(c, t);
+		spinlock_release(&c->rq_lock);
 	}
+	else
+		t->priority = priority;
+
+	// 대기 중이면 대기 큐에서도 새 우선순위 자리로 옮긴다
+	if (t->waitq != NULL)
+		waitq_requeue(t);
+	intr_set_level(old_level);
 }
 
 /* mlfqs */
 void mlfqs_calculate_priority(struct thread *t)
 {
-	if (t == idle_thread)
+	if (is_idle_thread(t))
 		return;
 	// fp 연산 함수를 사용하여 계산 결과의 소수 부분은 버리고 정수의 priority로 설정
-	t->priority = fp_to_int(add_mixed(div_mixed(t->recent_cpu, -4), PRI_MAX - t->nice * 2));
+	int priority = fp_to_int(add_mixed(div_mixed(t->recent_cpu, -4), PRI_MAX - t->nice * 2));
+
+	// run queue 레벨로 쓰이므로 PRI_MIN ~ PRI_MAX 범위로 제한
+	if (priority < PRI_MIN)
+		priority = PRI_MIN;
+	else if (priority > PRI_MAX)
+		priority = PRI_MAX;
+	thread_update_priority(t, priority);
 }
 
 void mlfqs_calculate_recent_cpu(struct thread *t)
 {
-	if (t == idle_thread)
+	if (is_idle_thread(t))
 		return;
-	t->recent_cpu = add_mixed(mult_fp(div_fp(mult_mixed(load_avg, 2), add_mixed(mult_mixed(load_avg, 2), 1)), t->recent_cpu), t->nice);
+	t->recent_cpu = add_mixed(mult_fp(div_fp(mult_mixed(decay_load_avg, 2), add_mixed(mult_mixed(decay_load_avg, 2), 1)), t->recent_cpu), t->nice);
 }
 
 void mlfqs_calculate_load_avg(void)
 {
-	int ready_threads;
-	if (thread_current() == idle_thread)
-		ready_threads = list_size(&ready_list);
-	else
-		ready_threads = list_size(&ready_list) + 1;
+	int ready_threads = 0;
+	int i;
 
+	// 모든 CPU의 ready 스레드와 실행중인(idle이 아닌) 스레드 수.
+	// run queue가 크기를 따로 세므로 CPU 수에만 비례한다.
+	for (i = 0; i < cpu_cnt; i++)
+		ready_threads += cpu_load(&cpus[i]);
+
+	seqlock_write_begin(&load_avg_seqlock);
 	load_avg = add_fp(mult_fp(div_fp(int_to_fp(59), int_to_fp(60)), load_avg),
 										mult_mixed(div_fp(int_to_fp(1), int_to_fp(60)), ready_threads));
+	seqlock_write_end(&load_avg_seqlock);
 	// printf("load_avg : %d\n", load_avg);
 }
 
 void mlfqs_increment_recent_cpu(void)
 {
-	if (thread_current() != idle_thread)
-		thread_current()->recent_cpu = add_mixed(thread_current()->recent_cpu, 1);
+	struct thread *curr = thread_current();
+
+	if (is_idle_thread(curr))
+		return;
+	curr->recent_cpu = add_mixed(curr->recent_cpu, 1);
+
+	// 다음 priority 재계산 대상으로 표시
+	if (!curr->mlfqs_dirty)
+	{
+		curr->mlfqs_dirty = true;
+		spinlock_acquire(&all_lock);
+		list_push_back(&mlfqs_dirty_list, &curr->mlfqs_elem);
+		spinlock_release(&all_lock);
+	}
 }
 
+/* Called by the timer interrupt once a second, after
+	 mlfqs_calculate_load_avg().  Wakes up mlfqs_decay_daemon() to
+	 decay recent_cpu outside the interrupt. */
 void mlfqs_recalculate_recent_cpu(void)
 {
-	/*
-	e: 이것은 list_elem 구조체의 포인터입니다.
-	list_elem은 연결 리스트에서 각 아이템을 연결하는 데 사용되는 구조체입니다.
-	이는 연결 리스트의 노드 역할을 하며,
-	실제 데이터(여기서는 thread 구조체)는 이 노드 내에 포함되어 있지 않습니다.
-	*/
-	struct list_elem *e;
+	sema_up(&mlfqs_decay_sema);
+}
 
-	for (e = list_begin(&all_list); e != list_end(&all_list); e = list_next(e))
+/* Recalculates the priority of each thread whose recent_cpu went
+	 up since the last call, which is usually just the running
+	 thread.  Called by the timer interrupt every fourth tick. */
+void mlfqs_recalculate_priority(void)
+{
+	spinlock_acquire(&all_lock);
+	while (!list_empty(&mlfqs_dirty_list))
 	{
-		/*
-		t: 이것은 thread 구조체의 포인터입니다.
-		thread 구조체는 스레드에 대한 정보를 저장합니다.
-		여기에는 스레드의 상태, 우선 순위, 스케줄링 관련 정보 등이 포함될 수 있습니다.
-		*/
-		struct thread *t = list_entry(e, struct thread, all_elem);
-		mlfqs_calculate_recent_cpu(t);
+		struct thread *t = list_entry(list_pop_front(&mlfqs_dirty_list), struct thread, mlfqs_elem);
+		t->mlfqs_dirty = false;
+		mlfqs_calculate_priority(t);
 	}
+	spinlock_release(&all_lock);
 }
 
-void mlfqs_recalculate_priority(void)
+/* Bottom half of the once-a-second MLFQS update.  Decays every
+	 thread's recent_cpu and recalculates its priority.
+
+	 Runs at nice NICE_MIN, which keeps its priority at PRI_MAX.
+	 Interrupts are let in every MLFQS_DECAY_BATCH threads; a
+	 marker element parked in all_list keeps the walk's place
+	 while threads are created or destroyed in between. */
+#define MLFQS_DECAY_BATCH 16
+
+static void
+mlfqs_decay_daemon(void *aux UNUSED)
 {
-	struct list_elem *e;
+	struct thread *curr = thread_current();
+	struct list_elem marker;
 
-	for (e = list_begin(&all_list); e != list_end(&all_list); e = list_next(e))
+	curr->nice = NICE_MIN;
+	mlfqs_calculate_priority(curr);
+
+	for (;;)
 	{
-		struct thread *t = list_entry(e, struct thread, all_elem);
-		mlfqs_calculate_priority(t);
+		enum intr_level old_level;
+		struct list_elem *e;
+		int batch = 0;
+
+		sema_down(&mlfqs_decay_sema);
+
+		old_level = intr_disable();
+		spinlock_acquire(&all_lock);
+		e = list_begin(&all_list);
+		while (e != list_end(&all_list))
+		{
+			struct thread *t = list_entry(e, struct thread, all_elem);
+
+			mlfqs_calculate_recent_cpu(t);
+			mlfqs_calculate_priority(t);
+			e = list_next(e);
+
+			if (++batch % MLFQS_DECAY_BATCH == 0 && e != list_end(&all_list))
+			{
+				list_insert(e, &marker);
+				spinlock_release(&all_lock);
+				intr_set_level(old_level);
+
+				old_level = intr_disable();
+				spinlock_acquire(&all_lock);
+				e = list_remove(&marker);
+			}
+		}
+		spinlock_release(&all_lock);
+		intr_set_level(old_level);
 	}
-}
\ No newline at end of file
+}
+
+/* MLFQS per-tick bookkeeping on CPU C. */
+static void
+mlfqs_tick(struct cpu *c)
+{
+	int64_t ticks = timer_ticks();
+
+	mlfqs_increment_recent_cpu();
+	if (ticks % 4 == 0)
+		mlfqs_recalculate_priority(); // recent_cpu가 바뀐 스레드만
+
+	// load_avg는 시스템 전체 값이므로 한 CPU에서만 갱신
+	if (c->id == 0 && ticks % TIMER_FREQ == 0) // TIMER_FREQ : 1초에 몇 개의 ticks가 실행되는지 (초기값 : 100)
+	{
+		decay_load_avg = load_avg;			// recent_cpu는 갱신 전 load_avg로 감쇠
+		mlfqs_calculate_load_avg();			// mlfqs 스레드를 깨우기 전에 세야 ready 수에 끼지 않는다
+		mlfqs_recalculate_recent_cpu(); // 모든 스레드의 감쇠는 mlfqs 스레드가 처리
+	}
+}
+
+/* Priority scheduling class.
+
+	 Ready threads wait in 64 priority FIFOs (see runqueue.h); the
+	 highest-priority thread runs, preempting lower-priority ones
+	 as soon as it becomes ready, and equal priorities share the
+	 CPU round-robin in TIME_SLICE ticks.  Threads waiting for a
+	 lock donate their priority to its holder. */
+static void
+prio_init(struct cpu *c)
+{
+	runqueue_init(&c->rq);
+}
+
+static void
+prio_start(void)
+{
+}
+
+static void
+prio_enqueue(struct cpu *c, struct thread *t)
+{
+	runqueue_push(&c->rq, t);
+}
+
+static struct thread *
+prio_pick_next(struct cpu *c)
+{
+	return runqueue_empty(&c->rq) ? NULL : runqueue_pop(&c->rq);
+}
+
+static bool
+prio_tick(struct cpu *c, struct thread *t UNUSED)
+{
+	return ++c->thread_ticks >= TIME_SLICE;
+}
+
+static bool
+prio_yield_check(struct cpu *c, struct thread *t)
+{
+	return runqueue_max_priority(&c->rq) > t->priority;
+}
+
+static void
+prio_priority_changed(struct cpu *c, struct thread *t)
+{
+	// 새 우선순위의 큐 맨 뒤로 옮긴다
+	runqueue_remove(&c->rq, t);
+	runqueue_push(&c->rq, t);
+}
+
+static void
+prio_set_priority(int new_priority)
+{
+	struct thread *current_thread = thread_current(); // 현재 스레드 가져오기
+	current_thread->init_priority = new_priority;			// 새로 들어온 우선순위를 현재 우선순위로
+	update_priority_before_donations();								// thread의 우선순위가 변경되면 donaitons 정보를 갱신
+}
+
+static void
+prio_set_nice(int nice)
+{
+	// 우선순위 스케줄러는 nice를 쓰지 않으므로 값만 저장
+	thread_current()->nice = nice;
+}
+
+static void
+prio_lock_wait(struct thread *t, struct lock *lock)
+{
+	// 우선순위 지켜서 donations에 삽입
+	list_insert_ordered(&lock->holder->donations, &t->donation_elem, cmp_d_priority, NULL);
+	donate_priority(t); // t의 priority를 비교하여 lock holder에게 상속
+}
+
+static void
+prio_lock_release(struct lock *lock)
+{
+	remove_donor(lock);									// 기부를 해준 donations에서 lock을 요청했던 스레드를 찾아서 제거
+	update_priority_before_donations(); // 제거하고 남은 donations에서 가장 높은 우선순위로 재조정
+}
+
+const struct sched_class sched_priority_class = {
+		.name = "priority",
+		.init = prio_init,
+		.start = prio_start,
+		.enqueue = prio_enqueue,
+		.pick_next = prio_pick_next,
+		.tick = prio_tick,
+		.yield_check = prio_yield_check,
+		.priority_changed = prio_priority_changed,
+		.set_priority = prio_set_priority,
+		.set_nice = prio_set_nice,
+		.lock_wait = prio_lock_wait,
+		.lock_release = prio_lock_release,
+};
+
+/* Multi-level feedback queue scheduling class ("-mlfqs").
+
+	 Uses the priority class's run queue, but computes priorities
+	 itself from nice and recent_cpu, so thread_set_priority() and
+	 priority donation do nothing. */
+static void
+mlfqs_start(void)
+{
+	thread_create("mlfqs", PRI_MAX, mlfqs_decay_daemon, NULL);
+}
+
+static bool
+mlfqs_sched_tick(struct cpu *c, struct thread *t)
+{
+	mlfqs_tick(c);
+	return prio_tick(c, t);
+}
+
+static void
+mlfqs_set_priority(int new_priority UNUSED)
+{
+}
+
+static void
+mlfqs_set_nice(int nice)
+{
+	enum intr_level old_level = intr_disable();
+	thread_current()->nice = nice;
+	mlfqs_calculate_priority(thread_current());
+	intr_set_level(old_level);
+}
+
+static void
+mlfqs_lock_wait(struct thread *t UNUSED, struct lock *lock UNUSED)
+{
+}
+
+static void
+mlfqs_lock_release(struct lock *lock UNUSED)
+{
+}
+
+const struct sched_class sched_mlfqs_class = {
+		.name = "mlfqs",
+		.init = prio_init,
+		.start = mlfqs_start,
+		.enqueue = prio_enqueue,
+		.pick_next = prio_pick_next,
+		.tick = mlfqs_sched_tick,
+		.yield_check = prio_yield_check,
+		.priority_changed = prio_priority_changed,
+		.set_priority = mlfqs_set_priority,
+		.set_nice = mlfqs_set_nice,
+		.lock_wait = mlfqs_lock_wait,
+		.lock_release = mlfqs_lock_release,
+};
@@ -0,0 +1,158 @@
+#include "threads/trace.h"
+#include <debug.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/cpu.h"
+#include "threads/interrupt.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+#include "intrinsic.h"
+
+/* Number of events kept per CPU.  Must be a power of 2. */
+#define TRACE_SIZE 512
+
+/* A recorded event. */
+struct trace_event {
+	uint64_t tsc;                   /* Time stamp counter. */
+	int32_t tid;                    /* Thread the event is about. */
+	uint8_t type;                   /* A `enum trace_type'. */
+	uint8_t cpu;                    /* CPU that recorded the event. */
+	union {
+		int32_t args[2];            /* Event-specific arguments. */
+		char name[16];              /* TRACE_CREATE: thread name. */
+	};
+};
+
+/* A CPU's ring.  Only that CPU writes it, with interrupts off. */
+struct trace_ring {
+	struct trace_event events[TRACE_SIZE];
+	uint64_t head;                  /* Number of events ever recorded. */
+};
+
+static struct trace_ring rings[MAX_CPUS];
+
+/* Time stamp counter and timer ticks at trace_init(), to convert
+   TSC deltas into time. */
+static uint64_t start_tsc;
+static int64_t start_ticks;
+
+/* Notes the time stamp counter that tracing starts at. */
+void
+trace_init (void) {
+	start_tsc = rdtsc ();
+	start_ticks = timer_ticks ();
+}
+
+/* Claims and returns the next slot in the running CPU's ring,
+   with its time stamp, type, CPU and TID filled in.  Interrupts
+   must be off. */
+static struct trace_event *
+trace_claim (enum trace_type type, int tid) {
+	struct cpu *c = this_cpu ();
+	struct trace_ring *r = &rings[c->id];
+	struct trace_event *e = &r->events[r->head++ % TRACE_SIZE];
+
+	e->tsc = rdtsc ();
+	e->tid = tid;
+	e->type = type;
+	e->cpu = c->id;
+	return e;
+}
+
+/* Records an event of the given TYPE about thread TID, with
+   arguments ARG and ARG2 as described for each type in
+   trace.h. */
+void
+trace_record (enum trace_type type, int tid, int arg, int arg2) {
+	enum intr_level old_level = intr_disable ();
+	struct trace_event *e = trace_claim (type, tid);
+
+	e->args[0] = arg;
+	e->args[1] = arg2;
+	intr_set_level (old_level);
+}
+
+/* Records that thread TID has been created with the given
+   NAME. */
+void
+trace_record_create (int tid, const char *name) {
+	enum intr_level old_level = intr_disable ();
+	struct trace_event *e = trace_claim (TRACE_CREATE, tid);
+
+	strlcpy (e->name, name, sizeof e->name);
+	intr_set_level (old_level);
+}
+
+/* Returns a name for thread status STATUS. */
+static const char *
+status_name (int status) {
+	switch (status) {
+		case THREAD_RUNNING:
+			return "running";
+		case THREAD_READY:
+			return "ready";
+		case THREAD_BLOCKED:
+			return "blocked";
+		case THREAD_DYING:
+			return "dying";
+		default:
+			return "unknown";
+	}
+}
+
+/* Prints E in the format that utils/pintos-trace reads. */
+static void
+print_event (const struct trace_event *e) {
+	printf ("trace %d %llu ", e->cpu, (unsigned long long) e->tsc);
+	switch (e->type) {
+		case TRACE_CREATE:
+			printf ("create %d %s\n", e->tid, e->name);
+			break;
+		case TRACE_SWITCH:
+			printf ("switch %d %d %s\n",
+			        e->tid, e->args[0], status_name (e->args[1]));
+			break;
+		case TRACE_WAKEUP:
+			printf ("wakeup %d %d %d\n", e->tid, e->args[0], e->args[1]);
+			break;
+		case TRACE_BLOCK:
+			printf ("block %d\n", e->tid);
+			break;
+		case TRACE_DONATE:
+			printf ("donate %d %d %d\n", e->tid, e->args[0], e->args[1]);
+			break;
+		case TRACE_PREEMPT:
+			printf ("preempt %d %s\n", e->tid,
+			        e->args[0] == TRACE_PREEMPT_SLICE ? "slice" : "ready");
+			break;
+		default:
+			NOT_REACHED ();
+	}
+}
+
+/* Prints every CPU's ring, oldest event first, preceded by the
+   TSC rate so that time stamps can be turned into time.
+
+   Each ring is dumped up to the events it held when its dump
+   began.  Printing may itself switch threads, which records more
+   events, so a ring that wraps around while it is being dumped
+   can show a few newer events in place of old ones. */
+void
+trace_dump (void) {
+	int64_t ticks = timer_ticks () - start_ticks;
+	uint64_t cycles = rdtsc () - start_tsc;
+	int i;
+
+	printf ("Trace: %llu cycles per tick, %d ticks per second\n",
+	        (unsigned long long) (ticks > 0 ? cycles / ticks : 0),
+	        TIMER_FREQ);
+	for (i = 0; i < cpu_cnt; i++) {
+		struct trace_ring *r = &rings[i];
+		uint64_t head = r->head;
+		uint64_t idx = head > TRACE_SIZE ? head - TRACE_SIZE : 0;
+
+		for (; idx < head; idx++)
+			print_event (&r->events[idx % TRACE_SIZE]);
+	}
+	printf ("Trace: end\n");
+}
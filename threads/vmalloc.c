@@ -0,0 +1,165 @@
+#include "threads/vmalloc.h"
+#include <bitmap.h>
+#include <debug.h>
+#include <round.h>
+#include "threads/init.h"
+#include "threads/mmu.h"
+#include "threads/palloc.h"
+#include "threads/pte.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
+#include "intrinsic.h"
+
+/* Virtually contiguous allocator.
+
+   palloc_get_multiple() needs physically contiguous free pages,
+   which may be impossible to find once memory is fragmented even
+   if plenty of it is free.  vmalloc() instead takes single pages
+   from the kernel pool wherever they are and maps them side by
+   side into VMALLOC_START...VMALLOC_END, in base_pml4.  The page
+   tables in that range are shared by all page maps, so the
+   mapping is visible in every address space at once.
+
+   Each allocation is followed by an unmapped guard page, which
+   catches overruns and marks where the allocation ends, so that
+   vfree() needs no size.
+
+   Mapping pages costs page table updates and TLB entries, so
+   callers should prefer palloc and fall back to vmalloc only
+   when it fails, as kvmalloc() does. */
+
+/* Pages in the vmalloc range. */
+#define VMALLOC_PAGES ((VMALLOC_END - VMALLOC_START) / PGSIZE)
+
+/* Virtual pages of the vmalloc range in use, including guard
+   pages. */
+static struct bitmap *va_map;
+static struct lock va_lock;
+
+static void unmap_pages (uint8_t *va, size_t page_cnt);
+
+/* Initializes the vmalloc range.  Must be called after the
+   kernel page map is set up. */
+void
+vmalloc_init (void) {
+	va_map = bitmap_create (VMALLOC_PAGES);
+	if (va_map == NULL)
+		PANIC ("vmalloc_init: out of memory");
+	lock_init (&va_lock);
+}
+
+/* Obtains and returns SIZE bytes of virtually contiguous kernel
+   memory, made of single pages from the kernel pool.  Returns a
+   null pointer if SIZE is 0 or if memory or virtual space is not
+   available. */
+void *
+vmalloc (size_t size) {
+	size_t page_cnt = DIV_ROUND_UP (size, PGSIZE);
+	size_t start, i;
+	uint8_t *va;
+
+	if (page_cnt == 0 || va_map == NULL)
+		return NULL;
+
+	/* Reserve the pages plus a guard page. */
+	lock_acquire (&va_lock);
+	start = bitmap_scan_and_flip (va_map, 0, page_cnt + 1, false);
+	lock_release (&va_lock);
+	if (start == BITMAP_ERROR)
+		return NULL;
+	va = (uint8_t *) VMALLOC_START + start * PGSIZE;
+
+	/* Back them. */
+	for (i = 0; i < page_cnt; i++) {
+		void *page = palloc_get_page (0);
+		uint64_t *pte;
+
+		if (page == NULL)
+			goto fail;
+		pte = pml4e_walk (base_pml4, (uint64_t) (va + i * PGSIZE), 1);
+		if (pte == NULL) {
+			palloc_free_page (page);
+			goto fail;
+		}
+		ASSERT ((*pte & PTE_P) == 0);
+		*pte = vtop (page) | PTE_P | PTE_W;
+	}
+	return va;
+
+ fail:
+	unmap_pages (va, i);
+	lock_acquire (&va_lock);
+	bitmap_set_multiple (va_map, start, page_cnt + 1, false);
+	lock_release (&va_lock);
+	return NULL;
+}
+
+/* Frees the memory at VA, which must have been obtained from
+   vmalloc(). */
+void
+vfree (void *va_) {
+	uint8_t *va = va_;
+	size_t page_cnt = 0;
+	uint64_t *pte;
+
+	if (va == NULL)
+		return;
+	ASSERT (is_vmalloc_addr (va));
+	ASSERT (pg_ofs (va) == 0);
+
+	/* The allocation runs up to its guard page. */
+	while ((pte = pml4e_walk (base_pml4, (uint64_t) (va + page_cnt * PGSIZE), 0))
+	       != NULL && (*pte & PTE_P) != 0)
+		page_cnt++;
+	ASSERT (page_cnt > 0);
+
+	unmap_pages (va, page_cnt);
+	lock_acquire (&va_lock);
+	ASSERT (bitmap_all (va_map, pg_no (va) - pg_no (VMALLOC_START), page_cnt + 1));
+	bitmap_set_multiple (va_map, pg_no (va) - pg_no (VMALLOC_START),
+	                     page_cnt + 1, false);
+	lock_release (&va_lock);
+}
+
+/* Obtains and returns SIZE bytes of kernel memory, physically
+   contiguous if possible, otherwise from vmalloc().  Returns a
+   null pointer if memory is not available.  The memory is
+   page-aligned and must be freed with kvfree(). */
+void *
+kvmalloc (size_t size) {
+	size_t page_cnt = DIV_ROUND_UP (size, PGSIZE);
+	void *p;
+
+	if (page_cnt == 0)
+		return NULL;
+	p = palloc_get_multiple (0, page_cnt);
+	if (p == NULL && page_cnt > 1)
+		p = vmalloc (size);
+	return p;
+}
+
+/* Frees the SIZE bytes at P, which must have been obtained from
+   kvmalloc() with the same SIZE. */
+void
+kvfree (void *p, size_t size) {
+	if (is_vmalloc_addr (p))
+		vfree (p);
+	else
+		palloc_free_multiple (p, DIV_ROUND_UP (size, PGSIZE));
+}
+
+/* Unmaps the PAGE_CNT pages at VA and frees the pages that back
+   them. */
+static void
+unmap_pages (uint8_t *va, size_t page_cnt) {
+	size_t i;
+
+	for (i = 0; i < page_cnt; i++) {
+		uint64_t *pte = pml4e_walk (base_pml4, (uint64_t) (va + i * PGSIZE), 0);
+
+		ASSERT (pte != NULL && (*pte & PTE_P) != 0);
+		palloc_free_page (ptov (PTE_ADDR (*pte)));
+		*pte = 0;
+		invlpg ((uint64_t) (va + i * PGSIZE));
+	}
+}
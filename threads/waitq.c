@@ -0,0 +1,79 @@
+#include "threads/waitq.h"
+#include <debug.h>
+#include "threads/interrupt.h"
+#include "threads/thread.h"
+
+/* Returns true if the thread in A should be woken before the one
+   in B: it has a higher priority, or the same priority and
+   arrived first. */
+static bool
+wake_before (const struct heap_elem *a_, const struct heap_elem *b_,
+             void *aux UNUSED) {
+	const struct thread *a = heap_entry (a_, struct thread, wait_elem);
+	const struct thread *b = heap_entry (b_, struct thread, wait_elem);
+
+	if (a->priority != b->priority)
+		return a->priority > b->priority;
+	return a->wait_seq < b->wait_seq;
+}
+
+/* Initializes WQ as empty. */
+void
+waitq_init (struct waitq *wq) {
+	ASSERT (wq != NULL);
+
+	heap_init (&wq->heap, wake_before, NULL);
+	wq->next_seq = 0;
+}
+
+/* Returns true if no thread waits on WQ. */
+bool
+waitq_empty (const struct waitq *wq) {
+	return heap_empty (&wq->heap);
+}
+
+/* Adds T, which must not be on any wait queue, to WQ. */
+void
+waitq_push (struct waitq *wq, struct thread *t) {
+	ASSERT (intr_get_level () == INTR_OFF);
+	ASSERT (t->waitq == NULL);
+
+	t->waitq = wq;
+	t->wait_seq = wq->next_seq++;
+	heap_insert (&wq->heap, &t->wait_elem);
+}
+
+/* Removes and returns the thread that should be woken next from
+   WQ, which must not be empty.  Takes O(lg n) time. */
+struct thread *
+waitq_pop (struct waitq *wq) {
+	struct thread *t;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+	ASSERT (!waitq_empty (wq));
+
+	t = heap_entry (heap_pop_min (&wq->heap), struct thread, wait_elem);
+	t->waitq = NULL;
+	return t;
+}
+
+/* Removes T from the wait queue it is on. */
+void
+waitq_remove (struct thread *t) {
+	ASSERT (intr_get_level () == INTR_OFF);
+	ASSERT (t->waitq != NULL);
+
+	heap_remove (&t->waitq->heap, &t->wait_elem);
+	t->waitq = NULL;
+}
+
+/* Moves T, which is on a wait queue, to its place for its current
+   priority, keeping its place among threads of equal priority. */
+void
+waitq_requeue (struct thread *t) {
+	ASSERT (intr_get_level () == INTR_OFF);
+	ASSERT (t->waitq != NULL);
+
+	heap_remove (&t->waitq->heap, &t->wait_elem);
+	heap_insert (&t->waitq->heap, &t->wait_elem);
+}
@@ -0,0 +1,238 @@
+#include "threads/workqueue.h"
+#include <debug.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/interrupt.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+/* A work queue.
+
+   Pending work items wait on `pending', and `ready' counts them,
+   so an idle worker sleeps in sema_down() until there is work and
+   queue_work() wakes exactly one worker per item.  Like the
+   semaphore code, the queue is protected by disabling interrupts,
+   which is what makes queue_work() safe to call from an interrupt
+   handler. */
+struct workqueue {
+	char name[16];                  /* Name, for worker threads. */
+	struct list pending;            /* Queued, not yet started work. */
+	struct semaphore ready;         /* Counts items in `pending'. */
+	int worker_cnt;                 /* Number of worker threads. */
+	int running;                    /* Items now being run. */
+	int flush_waiters;              /* Threads in flush_workqueue(). */
+	struct semaphore flushed;       /* Ups flush waiters when idle. */
+};
+
+/* Number of workers in system_wq. */
+#define SYSTEM_WQ_WORKERS 2
+
+struct workqueue *system_wq;
+
+static thread_func worker_main;
+static timer_func delayed_work_timer;
+static void insert_work (struct workqueue *, struct work *);
+
+/* Creates system_wq.  Must be called after thread_start(). */
+void
+workqueue_init (void) {
+	system_wq = workqueue_create ("events", SYSTEM_WQ_WORKERS);
+	if (system_wq == NULL)
+		PANIC ("could not create system work queue");
+}
+
+/* Initializes W to run FUNC when a worker picks it up. */
+void
+work_init (struct work *w, work_func *func) {
+	ASSERT (w != NULL);
+	ASSERT (func != NULL);
+
+	w->func = func;
+	w->pending = false;
+	w->wq = NULL;
+}
+
+/* Initializes DW to run FUNC when a worker picks it up. */
+void
+delayed_work_init (struct delayed_work *dw, work_func *func) {
+	work_init (&dw->work, func);
+	timer_event_init (&dw->timer, delayed_work_timer, dw);
+}
+
+/* Creates and returns a work queue named NAME whose items are run
+   by MAX_WORKERS worker threads, which are started right away and
+   sleep while there is no work.  Returns a null pointer if memory
+   or threads run out.  Must not be called from an interrupt
+   handler.
+
+   The queue and its workers are never destroyed. */
+struct workqueue *
+workqueue_create (const char *name, int max_workers) {
+	struct workqueue *wq;
+	int i;
+
+	ASSERT (name != NULL);
+	ASSERT (max_workers > 0);
+	ASSERT (!intr_context ());
+
+	wq = malloc (sizeof *wq);
+	if (wq == NULL)
+		return NULL;
+
+	strlcpy (wq->name, name, sizeof wq->name);
+	list_init (&wq->pending);
+	sema_init (&wq->ready, 0);
+	wq->worker_cnt = 0;
+	wq->running = 0;
+	wq->flush_waiters = 0;
+	sema_init (&wq->flushed, 0);
+
+	for (i = 0; i < max_workers; i++) {
+		char thread_name[16];
+
+		snprintf (thread_name, sizeof thread_name, "%s/%d", name, i);
+		if (thread_create (thread_name, PRI_DEFAULT, worker_main, wq)
+				== TID_ERROR)
+			break;
+		wq->worker_cnt++;
+	}
+
+	/* Workers that did start keep a pointer to WQ, so it cannot be
+	   freed once any have; settle for a smaller pool. */
+	if (wq->worker_cnt == 0) {
+		free (wq);
+		return NULL;
+	}
+	return wq;
+}
+
+/* Queues W on WQ.  Returns true if W was queued, or false if it
+   was already pending.  May be called from an interrupt
+   handler. */
+bool
+queue_work (struct workqueue *wq, struct work *w) {
+	enum intr_level old_level;
+	bool queued = false;
+
+	ASSERT (wq != NULL);
+	ASSERT (w != NULL);
+
+	old_level = intr_disable ();
+	if (!w->pending) {
+		w->pending = true;
+		insert_work (wq, w);
+		queued = true;
+	}
+	intr_set_level (old_level);
+	return queued;
+}
+
+/* Queues DW on WQ once DELAY timer ticks have passed, or right
+   away if DELAY is not positive.  Returns true if DW was queued
+   or its timer started, or false if it was already pending.  May
+   be called from an interrupt handler. */
+bool
+queue_delayed_work (struct workqueue *wq, struct delayed_work *dw,
+                    int64_t delay) {
+	enum intr_level old_level;
+	bool queued = false;
+
+	ASSERT (wq != NULL);
+	ASSERT (dw != NULL);
+
+	old_level = intr_disable ();
+	if (!dw->work.pending) {
+		dw->work.pending = true;
+		if (delay > 0) {
+			dw->work.wq = wq;
+			timer_arm (&dw->timer, timer_ticks () + delay);
+		} else
+			insert_work (wq, &dw->work);
+		queued = true;
+	}
+	intr_set_level (old_level);
+	return queued;
+}
+
+/* Cancels DW if its delay has not yet run out.  Returns true if
+   DW was canceled, or false if it was not pending or had already
+   been handed to a worker. */
+bool
+cancel_delayed_work (struct delayed_work *dw) {
+	enum intr_level old_level = intr_disable ();
+	bool canceled = timer_cancel (&dw->timer);
+
+	if (canceled)
+		dw->work.pending = false;
+	intr_set_level (old_level);
+	return canceled;
+}
+
+/* Waits until WQ has no work pending or running.  Delayed work
+   whose delay has not run out is not waited for.  Must not be
+   called from one of WQ's own workers, which would wait on
+   itself forever. */
+void
+flush_workqueue (struct workqueue *wq) {
+	enum intr_level old_level;
+
+	ASSERT (wq != NULL);
+	ASSERT (!intr_context ());
+
+	old_level = intr_disable ();
+	while (!list_empty (&wq->pending) || wq->running > 0) {
+		wq->flush_waiters++;
+		sema_down (&wq->flushed);
+	}
+	intr_set_level (old_level);
+}
+
+/* Adds pending item W to WQ and wakes up a worker.  Interrupts
+   must be off. */
+static void
+insert_work (struct workqueue *wq, struct work *w) {
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	w->wq = wq;
+	list_push_back (&wq->pending, &w->elem);
+	sema_up (&wq->ready);
+}
+
+/* Timer callback that queues delayed work DW_ once its delay has
+   run out. */
+static void
+delayed_work_timer (void *dw_) {
+	struct delayed_work *dw = dw_;
+
+	insert_work (dw->work.wq, &dw->work);
+}
+
+/* Worker thread: runs WQ_'s items one at a time, sleeping while
+   there are none. */
+static void
+worker_main (void *wq_) {
+	struct workqueue *wq = wq_;
+
+	for (;;) {
+		enum intr_level old_level;
+		struct work *w;
+
+		sema_down (&wq->ready);
+
+		old_level = intr_disable ();
+		w = list_entry (list_pop_front (&wq->pending), struct work, elem);
+		w->pending = false;
+		wq->running++;
+		intr_set_level (old_level);
+
+		w->func (w);
+
+		old_level = intr_disable ();
+		wq->running--;
+		if (list_empty (&wq->pending) && wq->running == 0)
+			for (; wq->flush_waiters > 0; wq->flush_waiters--)
+				sema_up (&wq->flushed);
+		intr_set_level (old_level);
+	}
+}
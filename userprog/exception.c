@@ -137,6 +137,8 @@ page_fault(struct intr_frame *f)
 		 be assured of reading CR2 before it changed). */
 	intr_enable();
 
+	thread_current()->rusage.ru_faults++;
+
 	/* Determine cause. */
 	not_present = (f->error_code & PF_P) == 0;
 	write = (f->error_code & PF_W) != 0;
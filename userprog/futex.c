@@ -0,0 +1,175 @@
+#include "userprog/futex.h"
+#include <debug.h>
+#include <hash.h>
+#include <list.h>
+#include "threads/interrupt.h"
+#include "threads/mmu.h"
+#include "threads/thread.h"
+#include "devices/hrtimer.h"
+
+/* Fast user-space mutexes.
+
+   A futex is an int in user memory.  User code manipulates it
+   with atomic instructions and enters the kernel only to sleep
+   until the word changes, in futex_wait(), or to wake up threads
+   sleeping on it, in futex_wake().  Sleepers are found through a
+   hash table keyed by the kernel virtual address of the word,
+   which identifies the physical frame and offset holding it, so
+   that threads that map the same frame at different user
+   addresses still find each other.
+
+   The table is protected by disabling interrupts, which also
+   makes checking the word and going to sleep atomic with respect
+   to futex_wake(). */
+
+/* Number of hash buckets.  Must be a power of 2. */
+#define FUTEX_BUCKETS 64
+
+/* A thread sleeping in futex_wait(), on its own stack. */
+struct futex_waiter {
+	struct list_elem elem;      /* Element in a bucket. */
+	int *key;                   /* Kernel address of the word. */
+	struct thread *thread;      /* Sleeping thread. */
+	bool woken;                 /* Woken by futex_wake()? */
+};
+
+static struct list buckets[FUTEX_BUCKETS];
+
+/* Initializes the futex hash table. */
+void
+futex_init (void) {
+	size_t i;
+
+	for (i = 0; i < FUTEX_BUCKETS; i++)
+		list_init (&buckets[i]);
+}
+
+/* Returns the kernel address of the word at user address UADDR in
+   the running process, or a null pointer if it is not mapped. */
+static int *
+futex_key (int *uaddr) {
+	return pml4_get_page (thread_current ()->pml4, uaddr);
+}
+
+/* Returns the bucket that waiters on KEY go in. */
+static struct list *
+futex_bucket (int *key) {
+	return &buckets[hash_bytes (&key, sizeof key) & (FUTEX_BUCKETS - 1)];
+}
+
+/* Timer callback for futex_wait(): gives up on the wait of
+   WAITER_, unless futex_wake() got there first. */
+static void
+futex_timeout (void *waiter_) {
+	struct futex_waiter *waiter = waiter_;
+
+	if (!waiter->woken && waiter->thread->status == THREAD_BLOCKED) {
+		list_remove (&waiter->elem);
+		thread_unblock (waiter->thread);
+		preempt_priority ();
+	}
+}
+
+/* If the word at user address UADDR holds EXPECTED, sleeps until
+   futex_wake() wakes us up or, if TIMEOUT is positive, until
+   TIMEOUT milliseconds pass.  Returns 0 if woken by futex_wake(),
+   or -1 if the word did not hold EXPECTED, if the timeout
+   expired, or if UADDR is not mapped.  A TIMEOUT of 0 never
+   sleeps, and a negative TIMEOUT never expires. */
+int
+futex_wait (int *uaddr, int expected, int64_t timeout) {
+	struct futex_waiter waiter;
+	struct hrtimer_event timer;
+	enum intr_level old_level;
+	int *key;
+
+	ASSERT (!intr_context ());
+
+	old_level = intr_disable ();
+	key = futex_key (uaddr);
+	if (key == NULL || *key != expected || timeout == 0) {
+		intr_set_level (old_level);
+		return -1;
+	}
+
+	waiter.key = key;
+	waiter.thread = thread_current ();
+	waiter.woken = false;
+	list_push_back (futex_bucket (key), &waiter.elem);
+	if (timeout > 0) {
+		hrtimer_event_init (&timer, futex_timeout, &waiter);
+		hrtimer_arm (&timer, hrtimer_now () + timeout * 1000 * 1000);
+	}
+	thread_block ();
+	if (timeout > 0)
+		hrtimer_cancel (&timer);
+	intr_set_level (old_level);
+
+	return waiter.woken ? 0 : -1;
+}
+
+/* Wakes up to COUNT threads sleeping on the word at user address
+   UADDR, highest priority first.  Returns the number woken. */
+int
+futex_wake (int *uaddr, int count) {
+	enum intr_level old_level;
+	struct list *bucket;
+	int *key;
+	int woken = 0;
+
+	old_level = intr_disable ();
+	key = futex_key (uaddr);
+	if (key == NULL) {
+		intr_set_level (old_level);
+		return 0;
+	}
+
+	bucket = futex_bucket (key);
+	while (woken < count) {
+		struct futex_waiter *best = NULL;
+		struct list_elem *e;
+
+		for (e = list_begin (bucket); e != list_end (bucket); e = list_next (e)) {
+			struct futex_waiter *w = list_entry (e, struct futex_waiter, elem);
+			if (w->key == key
+			    && (best == NULL || w->thread->priority > best->thread->priority))
+				best = w;
+		}
+		if (best == NULL)
+			break;
+
+		list_remove (&best->elem);
+		best->woken = true;
+		thread_unblock (best->thread);
+		woken++;
+	}
+	if (woken > 0)
+		preempt_priority ();
+	intr_set_level (old_level);
+
+	return woken;
+}
+
+/* Wakes up every thread of the process led by LEADER that is
+   sleeping in futex_wait(), as if its timeout had expired, so
+   that it notices that the process is exiting. */
+void
+futex_wake_process (struct thread *leader) {
+	enum intr_level old_level = intr_disable ();
+	size_t i;
+
+	for (i = 0; i < FUTEX_BUCKETS; i++) {
+		struct list_elem *e = list_begin (&buckets[i]);
+
+		while (e != list_end (&buckets[i])) {
+			struct futex_waiter *w = list_entry (e, struct futex_waiter, elem);
+
+			e = list_next (e);
+			if (w->thread->leader == leader) {
+				list_remove (&w->elem);
+				thread_unblock (w->thread);
+			}
+		}
+	}
+	intr_set_level (old_level);
+}
@@ -14,11 +14,13 @@
 #include "threads/init.h"
 #include "threads/interrupt.h"
 #include "threads/palloc.h"
+#include "threads/vmalloc.h"
 #include "threads/thread.h"
 #include "threads/mmu.h"
 #include "threads/vaddr.h"
 #include "intrinsic.h"
 #include "threads/synch.h"
+#include "userprog/futex.h"
 #include "userprog/syscall.h"
 #ifdef VM
 #include "vm/vm.h"
@@ -28,6 +30,22 @@ static void process_cleanup(void);
 static bool load(const char *file_name, struct intr_frame *if_);
 static void initd(void *f_name);
 static void __do_fork(void *);
+static void rusage_add(struct rusage *, const struct rusage *);
+static void start_user_thread(void *);
+static void process_thread_exit(void);
+static void process_reap_threads(void);
+static bool fdt_create(struct thread *);
+
+/* FS 세그먼트의 base 주소를 담는 MSR. 유저 스레드의 TLS 포인터. */
+#define MSR_FS_BASE 0xc0000100
+
+/* process_thread_create()가 새 유저 스레드에 넘기는 정보 */
+struct thread_args
+{
+	struct thread *leader; /* 프로세스의 메인 스레드. */
+	struct intr_frame if_; /* 유저 모드로 돌아갈 때의 레지스터. */
+	uint64_t fs_base;			 /* TLS 포인터. */
+};
 
 void argument_stack(char **parse, int count, void **rsp);
 int process_add_file(struct file *file);
@@ -90,6 +108,8 @@ initd(void *f_name)
 
 	process_init(); // 프로세스 초기화
 
+	if (!fdt_create(thread_current()))
+		PANIC("Fail to launch initd\n");
 	if (process_exec(f_name) < 0) // 프로세스 로드하고 실행, 성공하면 0이상 값
 		PANIC("Fail to launch initd\n");
 	NOT_REACHED(); // 여기에 도착하면 프로그래밍 오류(process_exec에서 프로세스 시작되어 initd는 더이상 실행되면 안된다)
@@ -121,9 +141,151 @@ tid_t process_fork(const char *name, struct intr_frame *if_ UNUSED)
 	// 로드가 완료될 때 까지 부모 대기
 	sema_down(&child->load_sema);
 
+	// 자식이 부모를 복제하지 못했으면 회수하고 실패를 알린다
+	if (child->exit_status == TID_ERROR)
+	{
+		process_wait(pid);
+		return TID_ERROR;
+	}
+
 	return pid; // 자식프로세스의 pid 반환
 }
 
+/* 현재 프로세스에 유저 스레드를 만든다. 새 스레드는 F의 세그먼트와 플래그를
+ * 물려받아 유저 모드의 ENTRY(ARG0, ARG1)부터 STACK을 스택 꼭대기로 삼아
+ * 실행되고, FS base는 TLS로 한다. pml4, SPT, FDT는 메인 스레드의 것을
+ * 공유한다. 새 스레드의 tid를 반환하고, 만들지 못하면 TID_ERROR. */
+tid_t process_thread_create(struct intr_frame *f, uint64_t entry, uint64_t arg0,
+														uint64_t arg1, uint64_t stack, uint64_t tls)
+{
+	struct thread *curr = thread_current();
+	struct thread_args args;
+	struct thread *t;
+	tid_t tid;
+
+	args.leader = curr->leader;
+	args.fs_base = tls;
+	memcpy(&args.if_, f, sizeof args.if_);
+	args.if_.rip = entry;
+	args.if_.R.rdi = arg0;
+	args.if_.R.rsi = arg1;
+	args.if_.R.rax = 0;
+	// 함수에 들어간 직후처럼 16바이트 정렬된 주소 아래에 가짜 반환 주소 자리를 둔다
+	args.if_.rsp = (stack & ~(uint64_t)0xf) - sizeof(uint64_t);
+
+	tid = thread_create(curr->leader->name, PRI_DEFAULT, start_user_thread, &args);
+	if (tid == TID_ERROR)
+		return TID_ERROR;
+
+	// 유저 스레드는 자식 프로세스가 아니므로 wait()의 대상에서 뺀다
+	t = get_child_process(tid);
+	sema_down(&t->load_sema);
+	list_remove(&t->child_elem);
+	return tid;
+}
+
+/* process_thread_create()로 만든 스레드가 처음 실행하는 함수 */
+static void
+start_user_thread(void *aux)
+{
+	struct thread_args *args = aux;
+	struct thread *curr = thread_current();
+	struct thread *leader = args->leader;
+	struct intr_frame if_;
+
+	memcpy(&if_, &args->if_, sizeof if_);
+
+	curr->file_descriptor_table = leader->file_descriptor_table;
+	curr->leader = leader;
+	curr->pml4 = leader->pml4;
+	curr->fs_base = args->fs_base;
+
+	enum intr_level old_level = intr_disable();
+	list_push_back(&leader->threads, &curr->thread_elem);
+	leader->live_threads++;
+	intr_set_level(old_level);
+
+	process_activate(curr);
+	sema_up(&curr->load_sema); // 여기부터 args는 사라질 수 있다
+
+	process_check_exiting();
+	do_iret(&if_);
+	NOT_REACHED();
+}
+
+/* 같은 프로세스의 유저 스레드 TID가 끝나기를 기다리고 그 종료 상태를
+ * 반환한다. 그런 스레드가 없거나 이미 join했으면 -1. */
+int process_thread_join(tid_t tid)
+{
+	struct thread *curr = thread_current();
+	struct thread *leader = curr->leader;
+	struct thread *t = NULL;
+	int status;
+
+	// 찾은 스레드에 바로 표시해서 두 스레드가 같은 스레드를 join하지 못하게 한다.
+	// 끝날 때까지는 리스트에 남겨 두어야 process_get_rusage()가 그 사용량을 센다
+	enum intr_level old_level = intr_disable();
+	for (struct list_elem *e = list_begin(&leader->threads); e != list_end(&leader->threads); e = list_next(e))
+	{
+		struct thread *u = list_entry(e, struct thread, thread_elem);
+		if (u->tid == tid && u != curr && !u->joined)
+		{
+			t = u;
+			t->joined = true;
+			break;
+		}
+	}
+	intr_set_level(old_level);
+	if (t == NULL)
+		return -1;
+
+	sema_down(&t->wait_sema);
+	old_level = intr_disable();
+	list_remove(&t->thread_elem);
+	intr_set_level(old_level);
+	status = t->exit_status;
+	sema_up(&t->exit_sema);
+	return status;
+}
+
+/* 현재 프로세스를 STATUS로 종료시킨다. 호출한 스레드는 직접 thread_exit()해야
+ * 하고, 다른 스레드들은 다음에 유저 모드로 돌아가려 할 때 끝난다. */
+void process_terminate(int status)
+{
+	struct thread *leader = thread_current()->leader;
+
+	leader->exit_status = status;
+	leader->exiting = true;
+	futex_wake_process(leader); // futex에서 자고 있는 스레드도 깨워서 종료를 알게 한다
+}
+
+/* 현재 스레드의 TLS 포인터를 TLS로 바꾼다. */
+void process_set_tls(uint64_t tls)
+{
+	thread_current()->fs_base = tls;
+	write_msr(MSR_FS_BASE, tls);
+}
+
+/* 메인 스레드가 LEADER인 프로세스 전체의 자원 사용량을 USAGE에 채운다.
+ * 끝난 유저 스레드의 몫은 exited_rusage에 모여 있고, 아직 끝나지 않은
+ * 스레드의 몫은 각 스레드가 가지고 있다. */
+void process_get_rusage(struct thread *leader, struct rusage *usage)
+{
+	enum intr_level old_level = intr_disable();
+	*usage = leader->rusage;
+	rusage_add(usage, &leader->exited_rusage);
+	for (struct list_elem *e = list_begin(&leader->threads); e != list_end(&leader->threads); e = list_next(e))
+		rusage_add(usage, &list_entry(e, struct thread, thread_elem)->rusage);
+	intr_set_level(old_level);
+}
+
+/* 프로세스가 종료 중이면 현재 스레드를 끝낸다. 유저 모드로 돌아가기 전에 부른다. */
+void process_check_exiting(void)
+{
+	if (thread_current()->leader->exiting)
+		thread_exit();
+}
+
 /* pid를 인자로 받아 자식 스레드를 반환하는 함수 */
 struct thread *get_child_process(int pid)
 {
@@ -232,6 +394,10 @@ __do_fork(void *aux)
 	 * TODO:       from the fork() until this function successfully duplicates
 	 * TODO:       the resources of parent.*/
 	// 자식 프로세스의 FDT는 부모의 FDT와 동일하게 해줘야 한다.
+	if (!fdt_create(current))
+		goto error;
+	// 부모 프로세스의 다른 스레드가 그동안 파일을 닫지 못하게 FDT 락을 잡는다.
+	lock_acquire(&parent->leader->fdt_lock);
 	current->file_descriptor_table[0] = parent->file_descriptor_table[0];
 	current->file_descriptor_table[1] = parent->file_descriptor_table[1];
 	for (int i = 2; i < FDT_COUNT_LIMIT; i++)
@@ -241,7 +407,8 @@ __do_fork(void *aux)
 			continue;
 		current->file_descriptor_table[i] = file_duplicate(file);
 	}
-	current->fdidx = parent->fdidx;
+	current->fdidx = parent->leader->fdidx;
+	lock_release(&parent->leader->fdt_lock);
 
 	// 기다리고 있던 부모 대기
 	sema_up(&current->load_sema);
@@ -251,6 +418,7 @@ __do_fork(void *aux)
 	if (succ)
 		do_iret(&if_);
 error:
+	current->exit_status = TID_ERROR; // 부모가 깨어나서 실패를 알 수 있게 sema_up 전에 기록한다
 	sema_up(&current->load_sema);
 	exit(TID_ERROR);
 	// thread_exit();
@@ -382,6 +550,13 @@ int process_wait(tid_t child_tid UNUSED)
 	// 2) 자식이 종료될 때 까지 대기
 	sema_down(&child->wait_sema);
 
+	// 자식 프로세스와 자식이 회수한 자손들의 자원 사용량을 합산
+	struct thread *leader = thread_current()->leader;
+	struct rusage usage;
+	process_get_rusage(child, &usage);
+	rusage_add(&leader->child_rusage, &usage);
+	rusage_add(&leader->child_rusage, &child->child_rusage);
+
 	// 3) 자식이 종료됨을 알리는 wait_sema를 받으면 자식 리스트에서 제거
 	list_remove(&child->child_elem);
 
@@ -391,6 +566,20 @@ int process_wait(tid_t child_tid UNUSED)
 	return child->exit_status; // 5) 자식의 exit_status 반환
 }
 
+/* SRC의 자원 사용량을 DST에 더한다. */
+static void
+rusage_add(struct rusage *dst, const struct rusage *src)
+{
+	dst->ru_utime += src->ru_utime;
+	dst->ru_stime += src->ru_stime;
+	dst->ru_wtime += src->ru_wtime;
+	dst->ru_nvcsw += src->ru_nvcsw;
+	dst->ru_nivcsw += src->ru_nivcsw;
+	dst->ru_faults += src->ru_faults;
+	dst->ru_inbytes += src->ru_inbytes;
+	dst->ru_outbytes += src->ru_outbytes;
+}
+
 /* Exit the process. This function is called by thread_exit (). */
 // 실행중인 스레드 종료, exec에 추가해야될듯 ?
 void process_exit(void)
@@ -400,6 +589,15 @@ void process_exit(void)
 	 * TODO: Implement process termination message (see
 	 * TODO: project2/process_termination.html).
 	 * TODO: We recommend you to implement process resource cleanup here. */
+	if (curr->leader != curr)
+	{
+		process_thread_exit();
+		return;
+	}
+
+	// 0) 남은 유저 스레드를 모두 끝내고 나서 공유하던 자원을 정리한다
+	process_reap_threads();
+
 	/*1) FDT의 모든 파일을 닫고 메모리도 반환한다.
 
 		2) 현재 실행 중인 파일도 닫는다.
@@ -409,12 +607,17 @@ void process_exit(void)
 		4) 부모가 wait을 마무리하고 나서 signal을 보내줄 때까지 대기한다.*/
 
 	// 1) FDT의 모든 파일을 닫고 메모리 반환
-	for (int i = 0; i < FDT_COUNT_LIMIT; i++)
+	// 커널 스레드와 FDT를 만들기 전에 실패한 fork 자식에게는 FDT가 없다
+	if (curr->file_descriptor_table != NULL)
 	{
-		close(i);
+		for (int i = 0; i < FDT_COUNT_LIMIT; i++)
+		{
+			close(i);
+		}
+		// palloc_free_page(curr->file_descriptor_table); // 한 번에 하나의 메모리 페이지만 해제 -> FDT가 여러 페이지를 사용할 때 적절하게 해제가 안될 수도 있다
+		kvfree(curr->file_descriptor_table, FDT_PAGES * PGSIZE); // 여러 페이지 동시에 해제 -> 모든 관련 페이지를 한 번에 해제 -> 메모리 누수 방지 (mulit-oom), get이 multiple로 받아서 그런듯
+		curr->file_descriptor_table = NULL;
 	}
-	// palloc_free_page(curr->file_descriptor_table); // 한 번에 하나의 메모리 페이지만 해제 -> FDT가 여러 페이지를 사용할 때 적절하게 해제가 안될 수도 있다
-	palloc_free_multiple(curr->file_descriptor_table, FDT_PAGES); // 여러 페이지 동시에 해제 -> 모든 관련 페이지를 한 번에 해제 -> 메모리 누수 방지 (mulit-oom), get이 multiple로 받아서 그런듯
 
 	// 2) 실행 중인 파일도 닫는다 - 아직 구현 미진행
 	file_close(curr->running); // rox
@@ -427,6 +630,66 @@ void process_exit(void)
 	sema_down(&curr->exit_sema);
 }
 
+/* 유저 스레드를 끝낸다. 주소 공간과 FDT는 메인 스레드의 것이므로 놓기만 한다. */
+static void
+process_thread_exit(void)
+{
+	struct thread *curr = thread_current();
+	struct thread *leader = curr->leader;
+
+	curr->pml4 = NULL;
+	pml4_activate(NULL);
+	curr->file_descriptor_table = NULL;
+
+	// 사용량을 프로세스 몫으로 넘긴다. 이 스레드는 회수될 때까지 threads 리스트에
+	// 남아 있을 수 있으므로, 두 번 세지 않게 비운다
+	enum intr_level old_level = intr_disable();
+	rusage_add(&leader->exited_rusage, &curr->rusage);
+	memset(&curr->rusage, 0, sizeof curr->rusage);
+	leader->live_threads--;
+	intr_set_level(old_level);
+	sema_up(&leader->threads_sema);
+
+	// join하는 스레드나, join되지 않았다면 메인 스레드가 종료할 때 풀어 준다
+	sema_up(&curr->wait_sema);
+	sema_down(&curr->exit_sema);
+}
+
+/* 새 프로세스의 메인 스레드 T에 빈 FDT를 만든다. 유저 스레드는 메인 스레드의
+ * FDT를 같이 쓰므로, 프로세스를 만드는 initd()와 __do_fork()만 부른다. */
+static bool
+fdt_create(struct thread *t)
+{
+	// 연속된 페이지가 없으면 흩어진 페이지를 매핑해서라도 받는다
+	t->file_descriptor_table = kvmalloc(FDT_PAGES * PGSIZE);
+	if (t->file_descriptor_table == NULL)
+		return false;
+	memset(t->file_descriptor_table, 0, FDT_PAGES * PGSIZE);
+	return true;
+}
+
+/* 메인 스레드가 끝날 때 부른다. 다른 유저 스레드를 모두 종료시키고, 끝날 때까지
+ * 기다린 다음 join되지 않은 스레드를 정리한다. */
+static void
+process_reap_threads(void)
+{
+	struct thread *curr = thread_current();
+
+	if (curr->live_threads == 0 && list_empty(&curr->threads))
+		return;
+
+	if (!curr->exiting)
+		process_terminate(curr->exit_status);
+	while (curr->live_threads > 0)
+		sema_down(&curr->threads_sema);
+
+	while (!list_empty(&curr->threads))
+	{
+		struct thread *t = list_entry(list_pop_front(&curr->threads), struct thread, thread_elem);
+		sema_up(&t->exit_sema);
+	}
+}
+
 /* Free the current process's resources. */
 static void
 process_cleanup(void)
@@ -457,30 +720,50 @@ process_cleanup(void)
 }
 
 /* Project 2 - system-call */
+/* 현재 프로세스의 FDT 락을 잡는다. 같은 프로세스의 스레드들은 FDT와 그 안의
+ * struct file을 공유하므로, fd로 얻은 파일 객체는 이 락을 잡고 있는 동안에만
+ * 쓸 수 있다. 그래야 다른 스레드의 close()가 쓰는 도중에 파일을 닫지 못하고,
+ * 같은 파일의 위치(pos)를 동시에 바꾸지 못한다.
+ * filesys_lock도 잡을 때는 filesys_lock을 먼저 잡는다. */
+void process_lock_files(void)
+{
+	lock_acquire(&thread_current()->leader->fdt_lock);
+}
+
+/* process_lock_files()로 잡은 FDT 락을 놓는다. */
+void process_unlock_files(void)
+{
+	lock_release(&thread_current()->leader->fdt_lock);
+}
+
 /* 파일 객체에 대한 파일 디스크립터를 생성하는 함수 */
 int process_add_file(struct file *file)
 {
-	struct thread *curr = thread_current();
-	struct file **fdt = curr->file_descriptor_table;
+	struct thread *leader = thread_current()->leader; // fd 번호는 프로세스 단위
+	struct file **fdt = leader->file_descriptor_table;
+
+	ASSERT(lock_held_by_current_thread(&leader->fdt_lock));
 
 	// FDT 한계와 같지 않을때 까지 fdidx값을 증가시킨다
-	while (curr->fdidx < FDT_COUNT_LIMIT && fdt[curr->fdidx])
+	while (leader->fdidx < FDT_COUNT_LIMIT && fdt[leader->fdidx])
 	{
-		curr->fdidx++;
+		leader->fdidx++;
 	}
-	if (curr->fdidx >= FDT_COUNT_LIMIT)
+	if (leader->fdidx >= FDT_COUNT_LIMIT)
 	{
 		return -1;
 	}
-	fdt[curr->fdidx] = file; // 빈자리에 f를 넣고
-	return curr->fdidx;			 // fd 반환
+	fdt[leader->fdidx] = file; // 빈자리에 f를 넣고
+	return leader->fdidx;			 // fd 반환
 }
 
 /* 파일 객체를 검색하는 함수 */
 struct file *process_get_file(int fd)
 {
-	struct thread *curr = thread_current();
-	struct file **fdt = curr->file_descriptor_table;
+	struct thread *leader = thread_current()->leader;
+	struct file **fdt = leader->file_descriptor_table;
+
+	ASSERT(lock_held_by_current_thread(&leader->fdt_lock));
 
 	if (fd < 2 || fd >= FDT_COUNT_LIMIT) // fd가 2보다 작거나 한계만큼 크면 NULL
 	{
@@ -492,8 +775,10 @@ struct file *process_get_file(int fd)
 // 파일 디스크립터 테이블에서 파일 객체를 제거하는 함수
 void process_close_file(int fd)
 {
-	struct thread *curr = thread_current();
-	struct file **fdt = curr->file_descriptor_table;
+	struct thread *leader = thread_current()->leader;
+	struct file **fdt = leader->file_descriptor_table;
+
+	ASSERT(lock_held_by_current_thread(&leader->fdt_lock));
 	if (fd < 2 || fd >= FDT_COUNT_LIMIT)
 		return NULL;
 	fdt[fd] = NULL; // fd에 해당하는 index에 NULL값
@@ -506,6 +791,10 @@ void process_activate(struct thread *next)
 	/* Activate thread's page tables. */
 	pml4_activate(next->pml4);
 
+	// 유저 스레드마다 TLS 포인터가 다르다
+	if (next->pml4 != NULL)
+		write_msr(MSR_FS_BASE, next->fs_base);
+
 	/* Set thread's kernel stack for use in processing interrupts. */
 	tss_update(next);
 }
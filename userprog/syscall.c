@@ -12,11 +12,18 @@
 #include "include/lib/stdio.h"
 #include "include/lib/string.h"
 #include "userprog/process.h"
+#include "devices/input.h"
+#include "userprog/futex.h"
 #include "threads/palloc.h"
+#include "threads/mmu.h"
+#include "threads/vaddr.h"
+
+struct rwlock filesys_lock;
 
 void syscall_entry(void);
 void syscall_handler(struct intr_frame *);
 void check_address(void *addr);
+void check_buffer(void *buffer, unsigned size, bool writable);
 void halt(void);
 void exit(int status);
 bool create(const char *file, unsigned initial_size);
@@ -31,6 +38,10 @@ void close(int fd);
 int exec(const char *cmd_line);
 tid_t fork(const char *thread_name, struct intr_frame *f);
 int wait(int pid);
+int set_tickets(int tickets);
+int getrusage(int who, struct rusage *usage);
+void check_futex(int *addr);
+void user_thread_exit(int status);
 /* System call.
  *
  * Previously system call services was handled by the interrupt handler
@@ -56,7 +67,8 @@ void syscall_init(void)
 	write_msr(MSR_SYSCALL_MASK,
 						FLAG_IF | FLAG_TF | FLAG_DF | FLAG_IOPL | FLAG_AC | FLAG_NT);
 
-	lock_init(&filesys_lock); // 파일 시스템 코드가 실행되는 동안에는 한 번에 하나의 프로세스만 실행되도록 동기화를 해야한다.
+	futex_init();
+	rwlock_init_named(&filesys_lock, "filesys"); // 파일을 바꾸는 코드는 한 번에 하나의 프로세스만, 읽기만 하는 코드는 여럿이 동시에 실행할 수 있다.
 }
 
 /* The main system call interface */
@@ -121,10 +133,41 @@ void syscall_handler(struct intr_frame *f UNUSED)
 	case SYS_CLOSE:
 		close(f->R.rdi);
 		break;
+	case SYS_SET_TICKETS:
+		f->R.rax = set_tickets(f->R.rdi);
+		break;
+	case SYS_GETRUSAGE:
+		f->R.rax = getrusage(f->R.rdi, (struct rusage *)f->R.rsi);
+		break;
+	case SYS_FUTEX_WAIT:
+		check_futex((int *)f->R.rdi);
+		f->R.rax = futex_wait((int *)f->R.rdi, f->R.rsi, (int)f->R.rdx);
+		break;
+	case SYS_FUTEX_WAKE:
+		check_futex((int *)f->R.rdi);
+		f->R.rax = futex_wake((int *)f->R.rdi, f->R.rsi);
+		break;
+	case SYS_THREAD_CREATE:
+		check_address((void *)f->R.rdi);
+		check_address((void *)(f->R.r10 - 1)); // 스택 꼭대기 바로 아래
+		f->R.rax = process_thread_create(f, f->R.rdi, f->R.rsi, f->R.rdx, f->R.r10, f->R.r8);
+		break;
+	case SYS_THREAD_JOIN:
+		f->R.rax = process_thread_join(f->R.rdi);
+		break;
+	case SYS_THREAD_EXIT:
+		user_thread_exit(f->R.rdi);
+		break;
+	case SYS_SET_TLS:
+		process_set_tls(f->R.rdi);
+		break;
 	default:
 		printf("Wrong syscall_n : %d\n", syscall_n);
 		thread_exit();
 	}
+
+	// 다른 스레드가 프로세스를 종료시켰으면 유저 모드로 돌아가지 않는다
+	process_check_exiting();
 	// printf("system call!\n");
 	// thread_exit();
 }
@@ -147,6 +190,40 @@ void check_address(void *addr)
 	}
 }
 
+// 버퍼가 걸친 모든 페이지가 매핑되어 있는지, WRITABLE이면 쓰기도 가능한지 확인한다.
+// filesys_lock을 잡은 채 유저 버퍼에서 페이지 폴트가 나면 락을 놓지 못하고 종료하므로 락을 잡기 전에 부른다
+void check_buffer(void *buffer, unsigned size, bool writable)
+{
+	struct thread *t = thread_current();
+	uint8_t *upage;
+
+	check_address(buffer);
+	for (upage = pg_round_down(buffer); upage < (uint8_t *)buffer + size; upage += PGSIZE)
+	{
+		check_address(upage);
+		if (writable && !is_writable(pml4e_walk(t->pml4, (uint64_t)upage, 0)))
+			exit(-1);
+	}
+}
+
+// futex 단어는 유저 영역에 있고 int 크기로 정렬되어 있어야 한다
+void check_futex(int *addr)
+{
+	check_address(addr);
+	if ((uintptr_t)addr % sizeof *addr != 0)
+		exit(-1);
+}
+
+// 유저 스레드를 STATUS로 끝낸다. 메인 스레드가 부르면 프로세스가 종료된다
+void user_thread_exit(int status)
+{
+	struct thread *t = thread_current();
+	if (t->leader == t)
+		exit(status);
+	t->exit_status = status;
+	thread_exit();
+}
+
 /* 호출시 pintos 종료 */
 void halt(void)
 {
@@ -158,7 +235,8 @@ void exit(int status)
 {
 	struct thread *t = thread_current();
 	t->exit_status = status;
-	printf("%s: exit(%d)\n", t->name, t->exit_status); // 정상적으로 종료됐다면 status는 0
+	printf("%s: exit(%d)\n", t->leader->name, t->exit_status); // 정상적으로 종료됐다면 status는 0
+	process_terminate(status); // 유저 스레드가 부르더라도 프로세스 전체가 종료된다
 	thread_exit();
 }
 
@@ -199,23 +277,25 @@ bool remove(const char *file)
 int open(const char *file)
 {
 	check_address(file); // 유효한 지 확인
-	lock_acquire(&filesys_lock);
+	rwlock_acquire_write(&filesys_lock); // open_inodes 목록을 바꾼다
 	struct file *file_obj = filesys_open(file); // 열려고 하는 파일 객체정보 받기
 	// printf("%d\n", 1);
 	if (file_obj == NULL) // 생성 됐는지 확인
 	{
 		// printf("%d\n", 2);
-		lock_release(&filesys_lock);
+		rwlock_release_write(&filesys_lock);
 		return -1;
 	}
+	process_lock_files();
 	int fd = process_add_file(file_obj); // 만들어진 파일을 fdt 테이블에 추가
+	process_unlock_files();
 	// printf("open fd : %d\n", fd);
 	if (fd == -1) // 열수 없으면 -1 리턴
 	{
 		// printf("%d\n", 2);
 		file_close(file_obj); // 파일을 닫는다
 	}
-	lock_release(&filesys_lock);
+	rwlock_release_write(&filesys_lock);
 	// printf("%d\n", 3);
 	return fd;
 }
@@ -223,31 +303,30 @@ int open(const char *file)
 /* 파일 사이즈 반환하는 함수 */
 int filesize(int fd)
 {
+	int length = -1; // 존재하지 않으면 -1 리턴
+
+	process_lock_files();
 	struct file *file_obj = process_get_file(fd); // 파일 디스크립터 이용하여 파일 객체 검색
-	if (file_obj == NULL)
+	if (file_obj != NULL)
 	{
-		return -1; // 존재하지 않으면 -1 리턴
+		length = file_length(file_obj); // 파일 길이 리턴
 	}
-	return file_length(file_obj); // 파일 길이 리턴
+	process_unlock_files();
+	return length;
 }
 
 /* 해당 파일로 부터 값을 읽어 버퍼에 넣는 함수 */
 int read(int fd, void *buffer, unsigned size)
 {
-	// 유효한 주소인지 체크
-	check_address(buffer);
-	check_address(buffer + size - 1); // 버퍼 끝 주소도 유저 영역 내에 있는 지 확인
+	// 버퍼 전체가 쓰기 가능한 유저 페이지인지 체크
+	check_buffer(buffer, size, true);
 	unsigned char *buf = buffer;
 	int read_bytes = 0;
 
-	lock_acquire(&filesys_lock);
+	rwlock_acquire_read(&filesys_lock); // 읽기끼리는 동시에 진행
 	if (fd == STDIN_FILENO) // STDIN
 	{
-		for (int i = 0; i < size; i++)
-		{
-			buf[i] = input_getc(); // 키보드 입력을 한 바이트 씩 버퍼에 저장
-			read_bytes++;					 // 저장한 크기 키우기
-		}
+		read_bytes = input_read(buf, size); // 키보드 입력을 도착한 만큼씩 한 번에 버퍼에 저장
 	}
 	else if (fd == STDOUT_FILENO) // STDOUT
 	{
@@ -255,6 +334,8 @@ int read(int fd, void *buffer, unsigned size)
 	}
 	else
 	{
+		// 다른 프로세스와는 동시에 읽고, 같은 프로세스의 스레드끼리는 파일 위치를 공유하므로 차례로 읽는다
+		process_lock_files();
 		struct file *file_obj = process_get_file(fd);
 		if (file_obj == NULL)
 		{
@@ -264,18 +345,21 @@ int read(int fd, void *buffer, unsigned size)
 		{
 			read_bytes = file_read(file_obj, buffer, size); // 파일의 데이터 크기만큼 저장
 		}
+		process_unlock_files();
 	}
-	lock_release(&filesys_lock);
+	rwlock_release_read(&filesys_lock);
+	if (read_bytes > 0)
+		thread_current()->rusage.ru_inbytes += read_bytes;
 	return read_bytes; // 읽은 바이트 수 리턴
 }
 
 /* 열린 파일의 데이터를 기록하는 함수 */
 int write(int fd, void *buffer, unsigned size)
 {
-	check_address(buffer);
+	check_buffer(buffer, size, false);
 	int write_bytes = 0;
 
-	lock_acquire(&filesys_lock);
+	rwlock_acquire_write(&filesys_lock);
 	if (fd == STDOUT_FILENO)
 	{
 		putbuf(buffer, size);
@@ -287,6 +371,7 @@ int write(int fd, void *buffer, unsigned size)
 	}
 	else
 	{
+		process_lock_files();
 		struct file *file_obj = process_get_file(fd);
 		if (file_obj == NULL)
 		{
@@ -296,44 +381,62 @@ int write(int fd, void *buffer, unsigned size)
 		{
 			write_bytes = file_write(file_obj, buffer, size);
 		}
+		process_unlock_files();
 	}
-	lock_release(&filesys_lock);
+	rwlock_release_write(&filesys_lock);
+	if (write_bytes > 0)
+		thread_current()->rusage.ru_outbytes += write_bytes;
 	return write_bytes;
 }
 
 /* 파일 내에서 다음에 읽거나 쓸 바이트 위치를 변경하는 함수 */
 void seek(int fd, unsigned position)
 {
+	process_lock_files();
 	struct file *file_obj = process_get_file(fd);
-	if (file_obj == NULL)
+	if (file_obj != NULL)
 	{
-		return;
+		file_seek(file_obj, position);
 	}
-	file_seek(file_obj, position);
+	process_unlock_files();
 }
 
 /* 파일 내에서 다음에 읽거나 쓸 위치를 반환하는 함수 */
 unsigned tell(int fd)
 {
+	unsigned position = 0;
+
+	process_lock_files();
 	struct file *file_obj = process_get_file(fd);
-	if (file_obj == NULL)
+	if (file_obj != NULL)
 	{
-		return;
+		position = file_tell(file_obj);
 	}
-	return file_tell(file_obj);
+	process_unlock_files();
+	return position;
 }
 
 /* 파일 디스크립터를 닫는다 */
 void close(int fd)
 {
+	// FDT 락을 잡으면 같은 프로세스의 다른 스레드가 이 파일을 쓰고 있지 않고,
+	// FDT에서 빼고 나면 더는 이 파일을 찾을 수 없다
+	process_lock_files();
 	struct file *file_obj = process_get_file(fd);
 	// printf("close fd : %d\n", fd);
+	if (file_obj != NULL)
+	{
+		process_close_file(fd);
+	}
+	process_unlock_files();
 	if (file_obj == NULL)
 	{
 		return;
 	}
+
+	rwlock_acquire_write(&filesys_lock); // 파일을 닫으면 open_inodes 목록이 바뀐다
 	file_close(file_obj);
-	process_close_file(fd);
+	rwlock_release_write(&filesys_lock);
 }
 
 /* 현재 프로세스를 cmd_line에 주어진 실행 파일로 변경하고, 필요한 인수를 전달 */
@@ -344,6 +447,11 @@ int exec(const char *cmd_line)
 
 	check_address(cmd_line);
 
+	// 다른 유저 스레드가 주소 공간을 같이 쓰고 있으면 바꿀 수 없다
+	struct thread *curr = thread_current();
+	if (curr->leader != curr || curr->live_threads > 0)
+		return -1;
+
 	// process_exec 함수 안에서 filename을 변경해야 하므로
 	// 커널 메모리 공간에 cmd_line의 복사본을 만든다.
 	// caller 함수와 load() 사이 race condition 방지
@@ -371,4 +479,29 @@ tid_t fork(const char *thread_name, struct intr_frame *f)
 int wait(int pid)
 {
 	return process_wait(pid);
-}
\ No newline at end of file
+}
+
+/* 현재 스레드의 stride 스케줄러 티켓 수를 설정. 범위를 벗어나면 -1 */
+int set_tickets(int tickets)
+{
+	return thread_set_tickets(tickets) ? 0 : -1;
+}
+
+/* WHO(RUSAGE_SELF 또는 RUSAGE_CHILDREN)의 자원 사용량을 USAGE에 복사. 잘못된 WHO면 -1.
+ * 같은 프로세스의 모든 스레드를 합친 값이다 */
+int getrusage(int who, struct rusage *usage)
+{
+	struct thread *leader = thread_current()->leader;
+	struct rusage total;
+
+	check_buffer(usage, sizeof *usage, true);
+
+	if (who == RUSAGE_SELF)
+		process_get_rusage(leader, &total);
+	else if (who == RUSAGE_CHILDREN)
+		total = leader->child_rusage;
+	else
+		return -1;
+	*usage = total;
+	return 0;
+}